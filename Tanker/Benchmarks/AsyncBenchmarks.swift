@@ -0,0 +1,192 @@
+import CryptoKit
+import XCTest
+
+@testable import Tanker
+
+private func getEnv(_ key: String) -> String { ProcessInfo.processInfo.environment[key]! }
+
+private func createIdentity(appID: String, appSecret: String, userID: String) -> String {
+  let identityExpected = tanker_create_identity(appID.cString(using: .utf8), appSecret.cString(using: .utf8),
+                                                userID.cString(using: .utf8))!;
+  return try! getExpectedString(identityExpected);
+}
+
+private func createStoragePath() -> String {
+  let path = FileManager.default.temporaryDirectory.appendingPathComponent(NSUUID().uuidString);
+  try! FileManager.default.createDirectory(at: path, withIntermediateDirectories: true);
+  return path.path;
+}
+
+// Compares the per-call overhead of the async API with the completion handler API
+@available(iOS 13.0, *)
+class AsyncBenchmarks: XCTestCase {
+  private static let iterations = 1000;
+
+  private static var admin: TestAdmin!;
+  private static var appID: String!;
+  private static var tanker: Tanker!;
+
+  override class func setUp() {
+    super.setUp();
+    admin = TestAdmin(url: getEnv("TANKER_MANAGEMENT_API_URL"),
+                      appManagementToken: getEnv("TANKER_MANAGEMENT_API_ACCESS_TOKEN"),
+                      environmentName: getEnv("TANKER_MANAGEMENT_API_DEFAULT_ENVIRONMENT_NAME"));
+    let app = admin.createApp(withName: "sdk-ios-benchmarks")!["app"] as! NSDictionary;
+    appID = app["id"] as? String;
+
+    let options = TankerOptions();
+    options.url = getEnv("TANKER_APPD_URL");
+    options.appID = appID;
+    options.persistentPath = createStoragePath();
+    options.cachePath = createStoragePath();
+    options.sdkType = "sdk-ios-benchmarks";
+    // setUp runs on the main thread, which we block below
+    options.completionQueue = DispatchQueue(label: "io.tanker.benchmarks.async");
+    tanker = try! Tanker(options: options);
+
+    let identity = createIdentity(appID: appID, appSecret: app["secret"] as! String, userID: NSUUID().uuidString);
+    let semaphore = DispatchSemaphore(value: 0);
+    tanker.start(withIdentity: identity) { _, err in
+      XCTAssertNil(err);
+      tanker.registerIdentity(with: Verification(passphrase: "passphrase")) { err in
+        XCTAssertNil(err);
+        semaphore.signal();
+      }
+    }
+    semaphore.wait();
+    // measure the handler path as users get it by default
+    options.completionQueue = nil;
+  }
+
+  override class func tearDown() {
+    let semaphore = DispatchSemaphore(value: 0);
+    tanker.options.completionQueue = DispatchQueue(label: "io.tanker.benchmarks.async");
+    tanker.stop { _ in semaphore.signal() };
+    semaphore.wait();
+    admin.deleteApp(appID);
+    super.tearDown();
+  }
+
+  private func measureCalls(_ name: String, iterations: Int = iterations, _ call: () async throws -> ()) async throws {
+    try await call();
+    let start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    for _ in 0..<iterations {
+      try await call();
+    }
+    let elapsed = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+    Benchmark.report(name, duration: Double(elapsed) / Double(iterations) / Double(NSEC_PER_SEC));
+  }
+
+  func testEncryptWithCompletionHandler() async throws {
+    let clearData = Data(repeating: 42, count: 64);
+    try await measureCalls("encryptData, completion handler") {
+      _ = try await Self.tanker.encryptData(clearData);
+    }
+  }
+
+  func testEncryptWithAsync() async throws {
+    let clearData = Data(repeating: 42, count: 64);
+    try await measureCalls("encrypt, async") {
+      _ = try await Self.tanker.encrypt(clearData);
+    }
+  }
+
+  private static let streamSize = 16 * 1024 * 1024;
+  private static let streamIterations = 5;
+
+  private static func createStreamData() -> Data {
+    var data = Data(count: streamSize);
+    data.withUnsafeMutableBytes { arc4random_buf($0.baseAddress, $0.count) };
+    return data;
+  }
+
+  func testEncryptStreamWithInputStream() async throws {
+    let clearData = Self.createStreamData();
+    var buffer = [UInt8](repeating: 0, count: 1024 * 1024);
+    try await measureCalls("encryptStream 16MB, NSInputStream", iterations: Self.streamIterations) {
+      let encrypted = try await Self.tanker.encryptStream(InputStream(data: clearData));
+      encrypted.open();
+      while encrypted.read(&buffer, maxLength: buffer.count) > 0 {}
+      encrypted.close();
+    }
+  }
+
+  func testEncryptStreamWithAsyncSequence() async throws {
+    let clearData = Self.createStreamData();
+    try await measureCalls("encryptStream 16MB, AsyncSequence", iterations: Self.streamIterations) {
+      let encrypted = try await Self.tanker.encrypt(stream: InputStream(data: clearData));
+      for try await _ in encrypted {}
+    }
+  }
+
+  // Reads a file, encrypts it and hashes the output, as an upload would do.
+  // The native stream encrypts its chunks one after the other, read-ahead overlaps the three stages.
+  func testEncryptFileWithReadAhead() async throws {
+    let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(NSUUID().uuidString);
+    var clearData = Data(count: 64 * 1024 * 1024);
+    clearData.withUnsafeMutableBytes { arc4random_buf($0.baseAddress, $0.count) };
+    try clearData.write(to: fileURL);
+    defer {
+      try? FileManager.default.removeItem(at: fileURL);
+    }
+
+    for readAhead in [0, 1, 2, 4, 8] {
+      try await measureCalls("encryptStream 64MB file, readAhead \(readAhead)", iterations: Self.streamIterations) {
+        let encrypted = try await Self.tanker.encrypt(stream: InputStream(url: fileURL)!, readAhead: readAhead);
+        var hasher = SHA256();
+        for try await chunk in encrypted {
+          hasher.update(data: chunk);
+        }
+        _ = hasher.finalize();
+      }
+    }
+  }
+
+  // Time to the first decrypted frame after a seek in an encrypted 64MB media file
+  func testDecryptRangeAtRandomOffsets() async throws {
+    let fileSize = 64 * 1024 * 1024;
+    let frameSize: UInt64 = 256 * 1024;
+    var clearData = Data(count: fileSize);
+    clearData.withUnsafeMutableBytes { arc4random_buf($0.baseAddress, $0.count) };
+    let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(NSUUID().uuidString);
+    var encryptedData = Data();
+    for try await chunk in try await Self.tanker.encrypt(stream: InputStream(data: clearData)) {
+      encryptedData.append(chunk);
+    }
+    try encryptedData.write(to: fileURL);
+    defer {
+      try? FileManager.default.removeItem(at: fileURL);
+    }
+    let offsets = (0..<Self.streamIterations).map { _ in
+      UInt64(arc4random_uniform(UInt32(fileSize) - UInt32(frameSize)))
+    };
+
+    var iteration = 0;
+    try await measureCalls("first frame at a random offset of a 64MB file, whole stream decrypted",
+                           iterations: Self.streamIterations) {
+      let offset = Int(offsets[iteration % offsets.count]);
+      iteration += 1;
+      var decrypted = Data();
+      for try await chunk in try await Self.tanker.decrypt(stream: InputStream(url: fileURL)!) {
+        decrypted.append(chunk);
+      }
+      _ = decrypted.subdata(in: offset..<(offset + Int(frameSize)));
+    }
+
+    iteration = 0;
+    try await measureCalls("first frame at a random offset of a 64MB file, decryptRange",
+                           iterations: Self.streamIterations) {
+      let offset = offsets[iteration % offsets.count];
+      iteration += 1;
+      _ = try await Self.tanker.decrypt(range: offset..<(offset + frameSize), from: .file(fileURL));
+    }
+
+    // playback keeps the reader, and seeks forward most of the time
+    let reader = SeekableDecryptionReader(tanker: Self.tanker, source: .file(fileURL));
+    var position: UInt64 = 0;
+    try await measureCalls("next frame after a 4MB forward seek, decryptRange", iterations: Self.streamIterations) {
+      position += 4 * 1024 * 1024;
+      _ = try await reader.read(range: position..<(position + frameSize));
+    }
+  }
+}
@@ -0,0 +1,821 @@
+// https://github.com/Specta/Specta
+
+#import <Tanker/Tanker-Swift.h>
+
+#import <Tanker/TKRDataResult.h>
+#import <Tanker/TKREncryptionSession.h>
+#import <Tanker/TKREncryptionSessionPool.h>
+#import <Tanker/TKRLogQueue+Private.h>
+#import <Tanker/TKRTanker+Private.h>
+#import <Tanker/TKRTanker.h>
+#import <Tanker/TKRTankerOptions.h>
+#import <Tanker/TKRTracer.h>
+
+#import <Tanker/Storage/TKRDatastore.h>
+
+#import <Tanker/Utils/TKRUtils.h>
+
+#import "TKRBenchmark.h"
+#import "TKRTestAdmin.h"
+
+#import <Expecta/Expecta.h>
+#import <PromiseKit/PromiseKit.h>
+#import <Specta/Specta.h>
+
+#include <Tanker/ctanker.h>
+#include <Tanker/ctanker/identity.h>
+
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+
+static NSString* createIdentity(NSString* userID, NSString* appID, NSString* appSecret)
+{
+  char const* user_id = [userID cStringUsingEncoding:NSUTF8StringEncoding];
+  char const* app_id = [appID cStringUsingEncoding:NSUTF8StringEncoding];
+  char const* app_secret = [appSecret cStringUsingEncoding:NSUTF8StringEncoding];
+  tanker_expected_t* identity_expected = tanker_create_identity(app_id, app_secret, user_id);
+
+  NSError* err = nil;
+  char* identity = TKR_unwrapAndFreeExpected(identity_expected, &err);
+  assert(!err);
+  assert(identity);
+  return [[NSString alloc] initWithBytesNoCopy:identity
+                                        length:strlen(identity)
+                                      encoding:NSUTF8StringEncoding
+                                  freeWhenDone:YES];
+}
+
+static NSString* getPublicIdentity(NSString* identity)
+{
+  tanker_expected_t* identity_expected =
+      tanker_get_public_identity([identity cStringUsingEncoding:NSUTF8StringEncoding]);
+
+  NSError* err = nil;
+  char* public_identity = TKR_unwrapAndFreeExpected(identity_expected, &err);
+  assert(!err);
+  assert(public_identity);
+  return [[NSString alloc] initWithBytesNoCopy:public_identity
+                                        length:strlen(public_identity)
+                                      encoding:NSUTF8StringEncoding
+                                  freeWhenDone:YES];
+}
+
+static NSString* createStorageFullpath(NSSearchPathDirectory dir)
+{
+  NSArray* paths = NSSearchPathForDirectoriesInDomains(dir, NSUserDomainMask, YES);
+  NSString* path = [[paths objectAtIndex:0] stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  NSError* err;
+  BOOL success = [[NSFileManager defaultManager] createDirectoryAtPath:path
+                                           withIntermediateDirectories:YES
+                                                            attributes:nil
+                                                                 error:&err];
+  assert(success);
+  return path;
+}
+
+static TKRTankerOptions* createTankerOptions(NSString* url, NSString* appID)
+{
+  TKRTankerOptions* opts = [TKRTankerOptions options];
+  opts.url = url;
+  opts.appID = appID;
+  opts.persistentPath = createStorageFullpath(NSLibraryDirectory);
+  opts.cachePath = createStorageFullpath(NSCachesDirectory);
+  opts.sdkType = @"sdk-ios-benchmarks";
+  return opts;
+}
+
+static id hangWithAdapter(void (^handler)(PMKAdapter))
+{
+  return [PMKPromise hang:[PMKPromise promiseWithAdapter:^(PMKAdapter adapter) {
+                       handler(adapter);
+                     }]];
+}
+
+static id hangWithResolver(void (^handler)(PMKResolver))
+{
+  return [PMKPromise hang:[PMKPromise promiseWithResolver:^(PMKResolver resolve) {
+                       handler(resolve);
+                     }]];
+}
+
+static TKRTanker* startNewTanker(TKRTankerOptions* options, NSString* identity)
+{
+  TKRTanker* started = [TKRTanker tankerWithOptions:options error:nil];
+  assert(started);
+  NSError* err = hangWithResolver(^(PMKResolver resolve) {
+    [started startWithIdentity:identity
+             completionHandler:^(TKRStatus status, NSError* err) {
+               if (err)
+                 resolve(err);
+               else if (status == TKRStatusIdentityRegistrationNeeded)
+                 [started registerIdentityWithVerification:[[TKRVerification alloc] withPassphrase:@"passphrase"]
+                                         completionHandler:resolve];
+               else
+                 [started verifyIdentityWithVerification:[[TKRVerification alloc] withPassphrase:@"passphrase"]
+                                       completionHandler:resolve];
+             }];
+  });
+  assert(!err);
+  return started;
+}
+
+static NSArray<NSData*>* createMessages(NSUInteger count, NSUInteger size)
+{
+  NSMutableArray<NSData*>* messages = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; ++i)
+  {
+    NSMutableData* message = [NSMutableData dataWithLength:size];
+    arc4random_buf(message.mutableBytes, size);
+    [messages addObject:message];
+  }
+  return messages;
+}
+
+// Number of live allocations of the default zone, the difference around a call is what it left allocated
+static size_t liveAllocations(void)
+{
+  malloc_statistics_t stats;
+  malloc_zone_statistics(malloc_default_zone(), &stats);
+  return stats.blocks_in_use;
+}
+
+static uint64_t residentSize(void)
+{
+  task_vm_info_data_t info;
+  mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+  kern_return_t kr = task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count);
+  assert(kr == KERN_SUCCESS);
+  return info.resident_size;
+}
+
+// Highest increase of the resident size while block runs, sampled every millisecond
+static uint64_t peakResidentIncrease(void (^block)(void))
+{
+  uint64_t const before = residentSize();
+  __block uint64_t peak = before;
+  dispatch_queue_t queue = dispatch_queue_create("io.tanker.benchmarks.resident", DISPATCH_QUEUE_SERIAL);
+  dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+  dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, NSEC_PER_MSEC, 0);
+  dispatch_source_set_event_handler(timer, ^{
+    peak = MAX(peak, residentSize());
+  });
+  dispatch_resume(timer);
+  block();
+  dispatch_source_cancel(timer);
+  dispatch_sync(queue, ^{
+    peak = MAX(peak, residentSize());
+  });
+  return peak - before;
+}
+
+// One allocation per string, the way arrays were converted before being converted in a single allocation
+static char** convertStringsOneByOne(NSArray<NSString*>* strings)
+{
+  char** c_strs = (char**)malloc(strings.count * sizeof(char*));
+  for (NSUInteger i = 0; i < strings.count; ++i)
+    c_strs[i] = strdup(strings[i].UTF8String);
+  return c_strs;
+}
+
+static void freeStringsOneByOne(char** c_strs, NSUInteger count)
+{
+  for (NSUInteger i = 0; i < count; ++i)
+    free(c_strs[i]);
+  free(c_strs);
+}
+
+SpecBegin(TankerBenchmarks)
+    describe(@"Tanker Benchmarks", ^{
+      __block TKRTestAdmin* admin;
+      __block NSString* url;
+      __block NSString* appID;
+      __block NSString* appSecret;
+      __block TKRTanker* tanker;
+
+      beforeAll(^{
+        NSDictionary* env = [[NSProcessInfo processInfo] environment];
+        NSString* appManagementToken = env[@"TANKER_MANAGEMENT_API_ACCESS_TOKEN"];
+        expect(appManagementToken).toNot.beNil();
+        NSString* appManagementUrl = env[@"TANKER_MANAGEMENT_API_URL"];
+        expect(appManagementUrl).toNot.beNil();
+        NSString* environmentName = env[@"TANKER_MANAGEMENT_API_DEFAULT_ENVIRONMENT_NAME"];
+        expect(environmentName).toNot.beNil();
+        url = env[@"TANKER_APPD_URL"];
+        expect(url).toNot.beNil();
+
+        admin = [TKRTestAdmin adminWithUrl:appManagementUrl
+                        appManagementToken:appManagementToken
+                           environmentName:environmentName];
+        NSDictionary* appDescriptor = [admin createAppWithName:@"sdk-ios-benchmarks"][@"app"];
+        appID = appDescriptor[@"id"];
+        appSecret = appDescriptor[@"secret"];
+
+        tanker = [TKRTanker tankerWithOptions:createTankerOptions(url, appID) error:nil];
+        expect(tanker).toNot.beNil();
+        NSString* identity = createIdentity([[NSUUID UUID] UUIDString], appID, appSecret);
+        NSError* err = hangWithResolver(^(PMKResolver resolve) {
+          [tanker startWithIdentity:identity
+                  completionHandler:^(TKRStatus status, NSError* err) {
+                    if (err)
+                      resolve(err);
+                    else
+                      [tanker registerIdentityWithVerification:[[TKRVerification alloc] withPassphrase:@"passphrase"]
+                                             completionHandler:resolve];
+                  }];
+        });
+        expect(err).to.beNil();
+      });
+
+      afterAll(^{
+        hangWithResolver(^(PMKResolver resolve) {
+          [tanker stopWithCompletionHandler:resolve];
+        });
+        [admin deleteApp:appID];
+      });
+
+      describe(@"batch", ^{
+        NSUInteger const messageCount = 1000;
+        __block NSArray<NSData*>* clearMessages;
+        __block NSArray<NSData*>* encryptedMessages;
+
+        beforeAll(^{
+          clearMessages = createMessages(messageCount, 64);
+          NSArray<TKRDataResult*>* results = hangWithResolver(^(PMKResolver resolve) {
+            [tanker encryptDataBatch:clearMessages completionHandler:resolve];
+          });
+          NSMutableArray<NSData*>* encrypted = [NSMutableArray arrayWithCapacity:messageCount];
+          for (TKRDataResult* result in results)
+            [encrypted addObject:result.data];
+          encryptedMessages = encrypted;
+        });
+
+        it(@"encrypts 1k small messages in a loop", ^{
+          [TKRBenchmark measure:@"encryptData loop (1k x 64B)"
+                     iterations:5
+                          block:^{
+                            hangWithResolver(^(PMKResolver resolve) {
+                              __block NSUInteger remaining = messageCount;
+                              for (NSData* message in clearMessages)
+                                [tanker encryptData:message
+                                    completionHandler:^(NSData* encrypted, NSError* err) {
+                                      if (--remaining == 0)
+                                        resolve(nil);
+                                    }];
+                            });
+                          }];
+        });
+
+        it(@"encrypts 1k small messages in a batch", ^{
+          [TKRBenchmark measure:@"encryptDataBatch (1k x 64B)"
+                     iterations:5
+                          block:^{
+                            hangWithResolver(^(PMKResolver resolve) {
+                              [tanker encryptDataBatch:clearMessages completionHandler:resolve];
+                            });
+                          }];
+        });
+
+        it(@"decrypts 1k small messages in a loop", ^{
+          [TKRBenchmark measure:@"decryptData loop (1k x 64B)"
+                     iterations:5
+                          block:^{
+                            hangWithResolver(^(PMKResolver resolve) {
+                              __block NSUInteger remaining = messageCount;
+                              for (NSData* message in encryptedMessages)
+                                [tanker decryptData:message
+                                    completionHandler:^(NSData* decrypted, NSError* err) {
+                                      if (--remaining == 0)
+                                        resolve(nil);
+                                    }];
+                            });
+                          }];
+        });
+
+        it(@"decrypts 1k small messages in a batch", ^{
+          [TKRBenchmark measure:@"decryptDataBatch (1k x 64B)"
+                     iterations:5
+                          block:^{
+                            hangWithResolver(^(PMKResolver resolve) {
+                              [tanker decryptDataBatch:encryptedMessages completionHandler:resolve];
+                            });
+                          }];
+        });
+      });
+
+      describe(@"completion queue", ^{
+        __block NSTimeInterval (^latencyWithBusyMainThread)(dispatch_queue_t) = ^(dispatch_queue_t queue) {
+          tanker.options.completionQueue = queue;
+          NSData* clearData = createMessages(1, 64)[0];
+          NSUInteger const iterations = 20;
+          uint64_t total = 0;
+          for (NSUInteger i = 0; i < iterations; ++i)
+          {
+            // keep the main thread busy for ~200ms
+            for (int j = 0; j < 100; ++j)
+              dispatch_async(dispatch_get_main_queue(), ^{
+                usleep(2000);
+              });
+            uint64_t const start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            NSNumber* end = hangWithResolver(^(PMKResolver resolve) {
+              [tanker encryptData:clearData
+                  completionHandler:^(NSData* encrypted, NSError* err) {
+                    resolve(@(clock_gettime_nsec_np(CLOCK_UPTIME_RAW)));
+                  }];
+            });
+            total += end.unsignedLongLongValue - start;
+            // drain the remaining busy work before the next iteration
+            hangWithResolver(^(PMKResolver resolve) {
+              dispatch_async(dispatch_get_main_queue(), ^{
+                resolve(nil);
+              });
+            });
+          }
+          tanker.options.completionQueue = nil;
+          return (NSTimeInterval)total / iterations / NSEC_PER_SEC;
+        };
+
+        it(@"measures the latency of a call on the main queue while the main thread is busy", ^{
+          [TKRBenchmark report:@"encryptData latency, busy main thread, main queue"
+                      duration:latencyWithBusyMainThread(dispatch_get_main_queue())];
+        });
+
+        it(@"measures the latency of a call on a background queue while the main thread is busy", ^{
+          dispatch_queue_t queue = dispatch_queue_create("io.tanker.benchmarks.completion", DISPATCH_QUEUE_SERIAL);
+          [TKRBenchmark report:@"encryptData latency, busy main thread, background queue"
+                      duration:latencyWithBusyMainThread(queue)];
+        });
+      });
+
+      describe(@"lifecycle", ^{
+        NSUInteger const iterations = 10;
+
+        it(@"measures a blocking creation", ^{
+          uint64_t total = 0;
+          for (NSUInteger i = 0; i < iterations; ++i)
+          {
+            TKRTankerOptions* options = createTankerOptions(url, appID);
+            uint64_t const start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            TKRTanker* created = [TKRTanker tankerWithOptions:options error:nil];
+            total += clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+            expect(created).toNot.beNil();
+          }
+          [TKRBenchmark report:@"tankerWithOptions:error:, caller blocked"
+                      duration:(NSTimeInterval)total / iterations / NSEC_PER_SEC];
+        });
+
+        it(@"measures an asynchronous creation", ^{
+          uint64_t callerTotal = 0;
+          uint64_t handlerTotal = 0;
+          for (NSUInteger i = 0; i < iterations; ++i)
+          {
+            TKRTankerOptions* options = createTankerOptions(url, appID);
+            __block uint64_t callerEnd = 0;
+            uint64_t const start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            NSNumber* handlerEnd = hangWithResolver(^(PMKResolver resolve) {
+              [TKRTanker tankerWithOptions:options
+                         completionHandler:^(TKRTanker* created, NSError* err) {
+                           expect(created).toNot.beNil();
+                           resolve(@(clock_gettime_nsec_np(CLOCK_UPTIME_RAW)));
+                         }];
+              callerEnd = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            });
+            callerTotal += callerEnd - start;
+            handlerTotal += handlerEnd.unsignedLongLongValue - start;
+          }
+          [TKRBenchmark report:@"tankerWithOptions:completionHandler:, caller blocked"
+                      duration:(NSTimeInterval)callerTotal / iterations / NSEC_PER_SEC];
+          [TKRBenchmark report:@"tankerWithOptions:completionHandler:, until the handler is called"
+                      duration:(NSTimeInterval)handlerTotal / iterations / NSEC_PER_SEC];
+        });
+
+        it(@"measures releasing the last reference to a started Tanker", ^{
+          uint64_t total = 0;
+          for (NSUInteger i = 0; i < iterations; ++i)
+          {
+            uint64_t start;
+            @autoreleasepool
+            {
+              TKRTanker* started = [TKRTanker tankerWithOptions:createTankerOptions(url, appID) error:nil];
+              NSString* identity = createIdentity([[NSUUID UUID] UUIDString], appID, appSecret);
+              NSError* err = hangWithResolver(^(PMKResolver resolve) {
+                [started startWithIdentity:identity
+                         completionHandler:^(TKRStatus status, NSError* err) {
+                           if (err)
+                             resolve(err);
+                           else
+                             [started
+                                 registerIdentityWithVerification:[[TKRVerification alloc] withPassphrase:@"passphrase"]
+                                                completionHandler:resolve];
+                         }];
+              });
+              expect(err).to.beNil();
+              start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+              started = nil;
+            }
+            total += clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+          }
+          [TKRBenchmark report:@"release a started TKRTanker, caller blocked"
+                      duration:(NSTimeInterval)total / iterations / NSEC_PER_SEC];
+        });
+      });
+
+      describe(@"logs", ^{
+        NSUInteger const recordCount = 100000;
+        tanker_log_record_t const record = {.category = "benchmarks",
+                                            .level = TKRLogLevelDebug,
+                                            .file = __FILE__,
+                                            .line = __LINE__,
+                                            .message = "a debug message of a typical length, emitted on a hot path"};
+        TKRLogHandler handler = ^(TKRLogEntry* entry) {
+        };
+
+        afterEach(^{
+          [TKRTanker setMinimumLogLevel:TKRLogLevelError];
+        });
+
+        it(@"measures debug logs below the minimum level", ^{
+          [TKRTanker connectLogHandler:handler];
+          [TKRTanker setMinimumLogLevel:TKRLogLevelError];
+          [TKRBenchmark measure:@"debug logs, filtered out (100k)"
+                     iterations:5
+                          block:^{
+                            for (NSUInteger i = 0; i < recordCount; ++i)
+                              TKR_logQueuePush(&record);
+                          }];
+        });
+
+        it(@"measures debug logs given to the handler", ^{
+          [TKRTanker connectLogHandler:handler];
+          [TKRTanker setMinimumLogLevel:TKRLogLevelDebug];
+          uint64_t const droppedBefore = [TKRTanker droppedLogCount];
+          [TKRBenchmark measure:@"debug logs, queued (100k)"
+                     iterations:5
+                          block:^{
+                            for (NSUInteger i = 0; i < recordCount; ++i)
+                              TKR_logQueuePush(&record);
+                          }];
+          TKR_logQueueFlush();
+          NSLog(@"[benchmark] debug logs, queued (100k): %llu dropped",
+                (unsigned long long)([TKRTanker droppedLogCount] - droppedBefore));
+        });
+
+        it(@"measures debug logs converted and handled on the logging thread", ^{
+          // what every native log used to cost the thread emitting it
+          [TKRBenchmark measure:@"debug logs, synchronous handler (100k)"
+                     iterations:5
+                          block:^{
+                            for (NSUInteger i = 0; i < recordCount; ++i)
+                            @autoreleasepool
+                            {
+                              TKRLogEntry* entry = [[TKRLogEntry alloc] init];
+                              entry.category = [NSString stringWithCString:record.category
+                                                                  encoding:NSUTF8StringEncoding];
+                              entry.file = [NSString stringWithCString:record.file encoding:NSUTF8StringEncoding];
+                              entry.message = [NSString stringWithCString:record.message
+                                                                 encoding:NSUTF8StringEncoding];
+                              entry.level = (TKRLogLevel)record.level;
+                              entry.line = record.line;
+                              handler(entry);
+                            }
+                          }];
+        });
+      });
+
+      describe(@"share coalescing", ^{
+        NSUInteger const shareCount = 1000;
+        __block TKRTanker* recipientTanker;
+        __block TKRTanker* coalescingTanker;
+        __block NSString* recipientPublicIdentity;
+        __block NSArray<NSString*>* resourceIDs;
+        __block NSArray<NSString*>* coalescingResourceIDs;
+
+        NSArray<NSString*>* (^createResources)(TKRTanker*) = ^(TKRTanker* owner) {
+          NSArray<TKRDataResult*>* results = hangWithResolver(^(PMKResolver resolve) {
+            [owner encryptDataBatch:createMessages(shareCount, 16) completionHandler:resolve];
+          });
+          NSMutableArray<NSString*>* ids = [NSMutableArray arrayWithCapacity:shareCount];
+          for (TKRDataResult* result in results)
+            [ids addObject:[owner resourceIDOfEncryptedData:result.data error:nil]];
+          return ids;
+        };
+
+        // one share per resource, all issued before any completes
+        void (^shareInBurst)(TKRTanker*, NSArray<NSString*>*) = ^(TKRTanker* owner, NSArray<NSString*>* ids) {
+          TKRSharingOptions* options = [[TKRSharingOptions alloc] init];
+          options.shareWithUsers = @[ recipientPublicIdentity ];
+          hangWithResolver(^(PMKResolver resolve) {
+            __block NSUInteger remaining = ids.count;
+            for (NSString* resourceID in ids)
+              [owner shareResourceIDs:@[ resourceID ]
+                              options:options
+                    completionHandler:^(NSError* err) {
+                      expect(err).to.beNil();
+                      if (--remaining == 0)
+                        resolve(nil);
+                    }];
+          });
+        };
+
+        beforeAll(^{
+          NSString* recipientIdentity = createIdentity([[NSUUID UUID] UUIDString], appID, appSecret);
+          recipientTanker = startNewTanker(createTankerOptions(url, appID), recipientIdentity);
+          recipientPublicIdentity = getPublicIdentity(recipientIdentity);
+
+          TKRTankerOptions* options = createTankerOptions(url, appID);
+          options.shareCoalescingInterval = 0.01;
+          coalescingTanker = startNewTanker(options, createIdentity([[NSUUID UUID] UUIDString], appID, appSecret));
+
+          resourceIDs = createResources(tanker);
+          coalescingResourceIDs = createResources(coalescingTanker);
+        });
+
+        afterAll(^{
+          hangWithResolver(^(PMKResolver resolve) {
+            [recipientTanker stopWithCompletionHandler:resolve];
+          });
+          hangWithResolver(^(PMKResolver resolve) {
+            [coalescingTanker stopWithCompletionHandler:resolve];
+          });
+        });
+
+        it(@"shares 1k resources in a burst, one request each", ^{
+          [TKRBenchmark measure:@"shareResourceIDs burst (1k), not coalesced"
+                     iterations:3
+                          block:^{
+                            shareInBurst(tanker, resourceIDs);
+                          }];
+          NSLog(@"[benchmark] shareResourceIDs burst (1k), not coalesced: %lu native shares",
+                (unsigned long)shareCount);
+        });
+
+        it(@"shares 1k resources in a burst, coalesced", ^{
+          [TKRBenchmark measure:@"shareResourceIDs burst (1k), coalesced"
+                     iterations:3
+                          block:^{
+                            shareInBurst(coalescingTanker, coalescingResourceIDs);
+                          }];
+          NSUInteger const before = coalescingTanker.shareBatcher.nativeShareCount;
+          shareInBurst(coalescingTanker, coalescingResourceIDs);
+          NSLog(@"[benchmark] shareResourceIDs burst (1k), coalesced: %lu native shares",
+                (unsigned long)(coalescingTanker.shareBatcher.nativeShareCount - before));
+        });
+      });
+
+      describe(@"marshalling", ^{
+        NSUInteger const recipientCount = 1000;
+        __block TKRSharingOptions* options;
+
+        beforeAll(^{
+          NSMutableArray<NSString*>* identities = [NSMutableArray arrayWithCapacity:recipientCount];
+          for (NSUInteger i = 0; i < recipientCount; ++i)
+            [identities addObject:getPublicIdentity(createIdentity([[NSUUID UUID] UUIDString], appID, appSecret))];
+          options = [[TKRSharingOptions alloc] init];
+          options.shareWithUsers = identities;
+        });
+
+        it(@"converts 1k recipients one string at a time", ^{
+          @autoreleasepool
+          {
+            size_t const before = liveAllocations();
+            char** c_strs = convertStringsOneByOne(options.shareWithUsers);
+            NSLog(@"[benchmark] 1k recipients, one allocation per string: %zu allocations",
+                  liveAllocations() - before);
+            freeStringsOneByOne(c_strs, recipientCount);
+          }
+          [TKRBenchmark measure:@"1k recipients, one allocation per string"
+                     iterations:100
+                          block:^{
+                            @autoreleasepool
+                            {
+                              freeStringsOneByOne(convertStringsOneByOne(options.shareWithUsers), recipientCount);
+                            }
+                          }];
+        });
+
+        it(@"converts 1k recipients in a single allocation", ^{
+          @autoreleasepool
+          {
+            tanker_sharing_options_t sharing_options = TANKER_SHARING_OPTIONS_INIT;
+            size_t const before = liveAllocations();
+            expect(convertSharingOptions(options, &sharing_options)).to.beNil();
+            NSLog(@"[benchmark] 1k recipients, convertSharingOptions: %zu allocations", liveAllocations() - before);
+            TKR_freeCStringArray((char**)sharing_options.share_with_users, sharing_options.nb_users);
+          }
+          [TKRBenchmark measure:@"1k recipients, convertSharingOptions"
+                     iterations:100
+                          block:^{
+                            @autoreleasepool
+                            {
+                              tanker_sharing_options_t sharing_options = TANKER_SHARING_OPTIONS_INIT;
+                              convertSharingOptions(options, &sharing_options);
+                              TKR_freeCStringArray((char**)sharing_options.share_with_users, sharing_options.nb_users);
+                            }
+                          }];
+        });
+      });
+
+      describe(@"encryption session pool", ^{
+        NSUInteger const itemCount = 100;
+        __block NSArray<NSData*>* clearMessages;
+
+        beforeAll(^{
+          clearMessages = createMessages(itemCount, 64);
+        });
+
+        it(@"encrypts items with a new session each", ^{
+          [TKRBenchmark measure:@"encrypt with a new session per item (100 x 64B)"
+                     iterations:3
+                          block:^{
+                            for (NSData* message in clearMessages)
+                              hangWithAdapter(^(PMKAdapter adapter) {
+                                [tanker createEncryptionSessionWithCompletionHandler:^(TKREncryptionSession* session,
+                                                                                       NSError* err) {
+                                  [session encryptData:message completionHandler:adapter];
+                                }];
+                              });
+                          }];
+        });
+
+        it(@"encrypts items with pooled sessions", ^{
+          TKREncryptionSessionPool* pool = [TKREncryptionSessionPool poolWithTanker:tanker];
+          TKREncryptionOptions* options = [[TKREncryptionOptions alloc] init];
+          [TKRBenchmark measure:@"encrypt with pooled sessions (100 x 64B)"
+                     iterations:3
+                          block:^{
+                            for (NSData* message in clearMessages)
+                              hangWithAdapter(^(PMKAdapter adapter) {
+                                [pool encryptData:message options:options completionHandler:adapter];
+                              });
+                          }];
+        });
+      });
+
+      describe(@"datastore write-behind", ^{
+        NSUInteger const putCount = 500;
+        NSUInteger const valuesPerPut = 10;
+
+        // many small puts, like the native layer issues during session start
+        NSTimeInterval (^putValues)(NSTimeInterval) = ^(NSTimeInterval writeBehindDelay) {
+          NSString* name = [[NSUUID UUID] UUIDString];
+          NSError* err = nil;
+          NSString* persistentPath = [createStorageFullpath(NSLibraryDirectory) stringByAppendingPathComponent:name];
+          NSString* cachePath = [createStorageFullpath(NSCachesDirectory) stringByAppendingPathComponent:name];
+          TKRDatastore* db = [TKRDatastore datastoreWithPersistentPath:persistentPath cachePath:cachePath error:&err];
+          expect(err).to.beNil();
+          db.writeBehindDelay = writeBehindDelay;
+          NSUInteger const commitsBefore = db.cacheCommitCount;
+
+          NSDate* start = [NSDate date];
+          for (NSUInteger i = 0; i < putCount; ++i)
+          {
+            NSMutableDictionary<NSData*, NSData*>* keyValues = [NSMutableDictionary dictionary];
+            for (NSUInteger j = 0; j < valuesPerPut; ++j)
+              keyValues[[[NSUUID UUID].UUIDString dataUsingEncoding:NSUTF8StringEncoding]] =
+                  [NSMutableData dataWithLength:64];
+            expect([db cacheValues:keyValues onConflict:TKRDatastoreOnConflictReplace]).to.beNil();
+          }
+          NSTimeInterval const putDuration = -[start timeIntervalSinceNow];
+          [db close];
+          NSTimeInterval const totalDuration = -[start timeIntervalSinceNow];
+
+          NSLog(@"[benchmark] %lu cache puts, write-behind %gs: %lu commits, %.0f puts/s, %.0f puts/s including close",
+                (unsigned long)putCount,
+                writeBehindDelay,
+                (unsigned long)(db.cacheCommitCount - commitsBefore),
+                putCount / putDuration,
+                putCount / totalDuration);
+          return totalDuration;
+        };
+
+        it(@"writes cache values synchronously", ^{
+          [TKRBenchmark report:@"500 cache puts, synchronous" duration:putValues(0)];
+        });
+
+        it(@"writes cache values behind", ^{
+          [TKRBenchmark report:@"500 cache puts, write-behind 50ms" duration:putValues(0.05)];
+        });
+      });
+
+      describe(@"tracing", ^{
+        NSUInteger const messageCount = 1000;
+        __block NSData* message;
+
+        beforeAll(^{
+          message = [NSMutableData dataWithLength:64];
+        });
+
+        afterEach(^{
+          [TKRTracer setEnabled:NO];
+          [TKRTracer reset];
+        });
+
+        void (^encryptMessages)(void) = ^{
+          for (NSUInteger i = 0; i < messageCount; ++i)
+            hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker encryptData:message completionHandler:adapter];
+            });
+        };
+
+        it(@"encrypts with tracing disabled", ^{
+          [TKRBenchmark measure:@"encryptData loop, tracing disabled (1k x 64B)" iterations:3 block:encryptMessages];
+        });
+
+        it(@"encrypts with tracing enabled", ^{
+          [TKRTracer setEnabled:YES];
+          [TKRBenchmark measure:@"encryptData loop, tracing enabled (1k x 64B)" iterations:3 block:encryptMessages];
+
+          NSDictionary<NSString*, TKRTraceHistogram*>* histograms = [TKRTracer histograms];
+          [histograms enumerateKeysAndObjectsUsingBlock:^(NSString* name, TKRTraceHistogram* h, BOOL* stop) {
+            NSLog(@"[benchmark] span %@: count %lu, p50 %.1fus, p99 %.1fus, max %.1fus",
+                  name,
+                  (unsigned long)h.count,
+                  [h percentile:0.5] * 1e6,
+                  [h percentile:0.99] * 1e6,
+                  h.max * 1e6);
+          }];
+        });
+      });
+
+      describe(@"large data", ^{
+        NSUInteger const size = 512 * 1024 * 1024;
+        __block NSString* path;
+        __block NSData* mappedData;
+
+        beforeAll(^{
+          path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+          expect([[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil]).to.beTruthy();
+          NSFileHandle* file = [NSFileHandle fileHandleForWritingAtPath:path];
+          NSMutableData* chunk = [NSMutableData dataWithLength:16 * 1024 * 1024];
+          for (NSUInteger written = 0; written < size; written += chunk.length)
+          {
+            arc4random_buf(chunk.mutableBytes, chunk.length);
+            [file writeData:chunk];
+          }
+          [file closeFile];
+          mappedData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:nil];
+          expect(mappedData.length).to.equal(size);
+        });
+
+        afterAll(^{
+          mappedData = nil;
+          [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        });
+
+        void (^encryptMapped)(NSString*, NSURL*) = ^(NSString* name, NSURL* destination) {
+          __block uint64_t elapsed = 0;
+          uint64_t const increase = peakResidentIncrease(^{
+            uint64_t const start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            @autoreleasepool
+            {
+              NSData* encrypted = hangWithAdapter(^(PMKAdapter adapter) {
+                if (destination)
+                  [tanker encryptData:mappedData toFileAtURL:destination completionHandler:adapter];
+                else
+                  [tanker encryptData:mappedData completionHandler:adapter];
+              });
+              expect(encrypted.length).to.beGreaterThan(size);
+            }
+            elapsed = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+          });
+          [TKRBenchmark report:name duration:(NSTimeInterval)elapsed / NSEC_PER_SEC];
+          NSLog(@"[benchmark] %@: peak resident size +%llu MB", name, increase / (1024 * 1024));
+        };
+
+        it(@"encrypts a memory-mapped file to a file", ^{
+          NSURL* destination = [NSURL fileURLWithPath:[path stringByAppendingString:@".encrypted"]];
+          encryptMapped(@"encryptData mapped file, to a file (512MB)", destination);
+          [[NSFileManager defaultManager] removeItemAtURL:destination error:nil];
+        });
+
+        it(@"encrypts a memory-mapped file in memory", ^{
+          encryptMapped(@"encryptData mapped file, in memory (512MB)", nil);
+        });
+      });
+
+      describe(@"verification methods", ^{
+        it(@"gets verification methods from the server", ^{
+          [TKRBenchmark measure:@"verificationMethods (uncached)"
+                     iterations:20
+                          block:^{
+                            hangWithAdapter(^(PMKAdapter adapter) {
+                              [tanker verificationMethodsWithCompletionHandler:adapter];
+                            });
+                          }];
+        });
+
+        it(@"gets verification methods from the cache", ^{
+          hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker cachedVerificationMethodsWithCompletionHandler:adapter];
+          });
+          [TKRBenchmark measure:@"cachedVerificationMethods (cached)"
+                     iterations:20
+                          block:^{
+                            hangWithAdapter(^(PMKAdapter adapter) {
+                              [tanker cachedVerificationMethodsWithCompletionHandler:adapter];
+                            });
+                          }];
+        });
+      });
+    });
+
+SpecEnd
@@ -0,0 +1,29 @@
+#import <Foundation/Foundation.h>
+
+NS_SWIFT_NAME(Benchmark)
+@interface TKRBenchmark : NSObject
+
+// MARK: Class methods
+
+/*!
+ @brief Run a block several times and report its mean duration.
+
+ @param name the name under which the result is reported.
+ @param iterations the number of times the block is run.
+ @param block the measured block, it must only return once the measured work is done.
+
+ @return the mean duration of one iteration, in seconds.
+ */
++ (NSTimeInterval)measure:(nonnull NSString*)name
+               iterations:(NSUInteger)iterations
+                    block:(nonnull void (^)(void))block;
+
+/*!
+ @brief Report a duration measured by the caller.
+
+ @param name the name under which the result is reported.
+ @param duration the measured duration, in seconds.
+ */
++ (void)report:(nonnull NSString*)name duration:(NSTimeInterval)duration;
+
+@end
@@ -0,0 +1,31 @@
+#import "TKRBenchmark.h"
+
+#include <time.h>
+
+@implementation TKRBenchmark
+
+// MARK: Class methods
+
++ (NSTimeInterval)measure:(nonnull NSString*)name
+               iterations:(NSUInteger)iterations
+                    block:(nonnull void (^)(void))block
+{
+  // warm up caches and lazy initializations
+  block();
+
+  uint64_t const start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  for (NSUInteger i = 0; i < iterations; ++i)
+    block();
+  uint64_t const elapsed = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+
+  NSTimeInterval const mean = (NSTimeInterval)elapsed / iterations / NSEC_PER_SEC;
+  [self report:name duration:mean];
+  return mean;
+}
+
++ (void)report:(nonnull NSString*)name duration:(NSTimeInterval)duration
+{
+  NSLog(@"[benchmark] %@: %.3f ms", name, duration * 1000);
+}
+
+@end
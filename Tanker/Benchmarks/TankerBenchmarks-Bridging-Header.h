@@ -0,0 +1,5 @@
+#import "TKRBenchmark.h"
+#import "TKRTestAdmin.h"
+
+#include <Tanker/ctanker.h>
+#include <Tanker/ctanker/identity.h>
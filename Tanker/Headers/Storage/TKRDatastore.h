@@ -13,8 +13,17 @@ NS_SWIFT_NAME(Datastore)
                                        cachePath:(nonnull NSString*)cachePath
                                            error:(NSError* _Nullable* _Nonnull)err;
 
+// Cache writes are staged in memory and committed in grouped transactions at most writeBehindDelay seconds later.
+// 0 (the default) writes synchronously. Setting it back to 0 flushes staged writes.
+@property(nonatomic) NSTimeInterval writeBehindDelay;
+// Number of transactions committed to the cache database, each costing several fsyncs
+@property(readonly) NSUInteger cacheCommitCount;
+
+// discards staged cache writes
 - (nullable NSError*)nuke;
+// flushes staged cache writes
 - (void)close;
+- (nullable NSError*)flushCacheValues;
 
 - (nullable NSError*)cacheValues:(nonnull NSDictionary<NSData*, NSData*>*)keyValues
                       onConflict:(TKRDatastoreOnConflict)action;
@@ -1,5 +1,11 @@
+#include <stdbool.h>
 #include <stdint.h>
 
+// Sets the write-behind delay (0 disables it) of the datastores opened under cache_dir. Every instance created with
+// cache_dir registers, and unregisters once destroyed. Returns false when instances registered with another delay are
+// still alive, since the datastores opened under cache_dir cannot be told apart.
+bool TKR_datastore_register_settings(char const* cache_dir, double write_behind_delay);
+void TKR_datastore_unregister_settings(char const* cache_dir);
 void TKR_datastore_open(void* error_handle, void** datastore, char const* data_path, char const* cache_path);
 void TKR_datastore_close(void* db_handle);
 void TKR_datastore_nuke(void* datastore, void* error_handle);
@@ -1,6 +1,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import <Tanker/TKRCompletionHandlers.h>
+
 #include <Tanker/ctanker/stream.h>
 
 void readInput(uint8_t* _Nonnull out,
@@ -21,4 +23,17 @@ void readInput(uint8_t* _Nonnull out,
 @property int64_t cSize;
 @property(nullable) tanker_stream_read_operation_t* cOp;
 
+// Called on progressQueue with the number of bytes read so far
+@property(nullable) TKRStreamProgressHandler progressHandler;
+@property(nullable) dispatch_queue_t progressQueue;
+// Once set, reads fail instead of reaching the end of the input, which fails the native stream
+@property(readonly) BOOL cancelled;
+
+// Closes the input stream once the read in progress, if any, is over, and fails the pending read. Must be called on
+// the main queue
+- (void)cancel;
+// Drops the reference given to the native stream, if not done yet. Must be called on the main queue, once the native
+// stream will not read anymore
+- (void)releaseFromNative;
+
 @end
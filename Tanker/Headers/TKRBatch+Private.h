@@ -0,0 +1,45 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRCancellationToken.h>
+#import <Tanker/TKRCompletionHandlers.h>
+
+// Gathers the results of a batch operation, and calls the handler once every item has been processed
+@interface TKRBatchContext : NSObject
+
++ (nonnull instancetype)batchWithCount:(NSUInteger)count
+                                 queue:(nonnull dispatch_queue_t)queue
+                               handler:(nonnull TKRBatchDataHandler)handler;
+
+// Once the token is cancelled, the items not processed yet get a TKRErrorOperationCanceled error and the handler is
+// called right away. Results arriving afterwards are dropped.
+- (void)bindCancellationToken:(nullable TKRCancellationToken*)token;
+- (void)cancel;
+// Set by cancel, items should not be submitted anymore
+@property(readonly, getter=isCancelled) BOOL cancelled;
+
+- (void)setData:(nonnull NSData*)data atIndex:(NSUInteger)index;
+- (void)setError:(nonnull NSError*)error atIndex:(NSUInteger)index;
+
+@end
+
+// A single item of a batch, given as the argument of TKR_resolveBatchItem
+@interface TKRBatchItem : NSObject
+
++ (nonnull instancetype)itemWithBatch:(nonnull TKRBatchContext*)batch
+                                index:(NSUInteger)index
+                                input:(nonnull NSData*)input
+                               buffer:(nonnull uint8_t*)buffer
+                                 size:(uint64_t)size;
+
+@property(nonnull) TKRBatchContext* batch;
+@property NSUInteger index;
+// Keeps the input alive until the native future is done
+@property(nonnull) NSData* input;
+@property(nonnull) uint8_t* buffer;
+// Size of the output buffer, or 0 if the future resolves to the output size
+@property uint64_t size;
+
+@end
+
+// tanker_future_then callback: stores the item result in its batch, without hopping on the main queue
+void* _Nullable TKR_resolveBatchItem(void* _Nonnull future, void* _Nonnull arg);
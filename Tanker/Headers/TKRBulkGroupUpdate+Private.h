@@ -0,0 +1,26 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRCancellationToken.h>
+#import <Tanker/TKRCompletionHandlers.h>
+
+@class TKRTanker;
+
+// Creates or updates a group one chunk of identities at a time, so that only a chunk is converted to C strings and
+// sent at once. The next chunk is converted while the current one is in flight, and updates of the same group are
+// run one after the other, per tanker. A group created in several chunks gets the current user in its first chunk.
+// Cancelling the token lets the chunk in flight finish, the remaining identities are given back as pending.
+@interface TKRBulkGroupUpdate : NSObject
+
+// groupID is nil to create the group with the first chunk of usersToAdd
++ (nonnull instancetype)updateWithTanker:(nonnull TKRTanker*)tanker
+                                 groupID:(nullable NSString*)groupID
+                              usersToAdd:(nonnull NSArray<NSString*>*)usersToAdd
+                           usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
+                               chunkSize:(NSUInteger)chunkSize
+                       cancellationToken:(nullable TKRCancellationToken*)token
+                         progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+                       completionHandler:(nonnull TKRGroupUpdateResultHandler)handler;
+
+- (void)start;
+
+@end
@@ -0,0 +1,15 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRCancellationToken.h>
+
+NSError* _Nonnull TKR_createCanceledError(void);
+
+@interface TKRCancellationToken ()
+
+// Runs the handler once when the token is cancelled, right away if it already is.
+// Handlers are released once run or removed, they should not capture the operation strongly.
+- (nonnull id)addCancellationHandler:(nonnull dispatch_block_t)handler;
+// Called when the operation is over
+- (void)removeCancellationHandler:(nonnull id)registration;
+
+@end
@@ -0,0 +1,24 @@
+#import <Foundation/Foundation.h>
+
+/*!
+ @brief Cancels the operations it was given to
+
+ @discussion A single token can be given to several operations, e.g. every operation started by a screen, and cancels
+ them all at once. A cancelled operation completes with a TKRErrorOperationCanceled error.
+ */
+NS_SWIFT_NAME(CancellationToken)
+@interface TKRCancellationToken : NSObject
+
+/*!
+ @brief Create and return a token that is not cancelled.
+ */
++ (nonnull instancetype)token;
+
+/*!
+ @brief Cancel the operations given this token, and the ones it is given to afterwards.
+ */
+- (void)cancel;
+
+@property(readonly, getter=isCancelled) BOOL cancelled;
+
+@end
@@ -5,7 +5,10 @@
 @class TKRVerificationKey;
 @class TKRVerificationMethod;
 @class TKRAttachResult;
+@class TKRDataResult;
 @class TKREncryptionSession;
+@class TKRGroupUpdateResult;
+@class TKRTanker;
 @class TKRLogEntry;
 @class TKRVerification;
 
@@ -18,6 +21,15 @@
  */
 typedef void (^TKRStartHandler)(TKRStatus status, NSError* _Nullable err);
 
+/*!
+ @typedef TKRTankerHandler
+ @brief Block which will be called when a TKRTanker has been created.
+
+ @param tanker the created TKRTanker, or nil if an error occurred.
+ @param err the error which occurred, or nil.
+ */
+typedef void (^TKRTankerHandler)(TKRTanker* _Nullable tanker, NSError* _Nullable err);
+
 /*!
  @typedef TKREncryptedDataHandler
  @brief Block which will be called when data has been encrypted.
@@ -45,6 +57,14 @@ typedef void (^TKRDecryptedDataHandler)(NSData* _Nullable decryptedData, NSError
  */
 typedef void (^TKRDecryptedStringHandler)(NSString* _Nullable decryptedString, NSError* _Nullable err);
 
+/*!
+ @typedef TKRBatchDataHandler
+ @brief Block which will be called once every item of a batch has been processed.
+
+ @param results one result per input item, in the same order as the input.
+ */
+typedef void (^TKRBatchDataHandler)(NSArray<TKRDataResult*>* _Nonnull results);
+
 /*!
  @typedef TKRErrorHandler
  @brief Block which will be called with a NSError*, or nil.
@@ -71,6 +91,23 @@ typedef void (^TKRNonceHandler)(NSString* _Nullable nonce, NSError* _Nullable er
  */
 typedef void (^TKRGroupIDHandler)(NSString* _Nullable groupID, NSError* _Nullable err);
 
+/*!
+ @typedef TKRGroupUpdateProgressHandler
+ @brief Block which will be called each time a chunk of a group update has been processed.
+
+ @param processedCount the number of identities processed so far.
+ @param totalCount the number of identities to process.
+ */
+typedef void (^TKRGroupUpdateProgressHandler)(NSUInteger processedCount, NSUInteger totalCount);
+
+/*!
+ @typedef TKRGroupUpdateResultHandler
+ @brief Block which will be called when a chunked group update is over.
+
+ @param result the group ID, and the identities left to process if an error occurred.
+ */
+typedef void (^TKRGroupUpdateResultHandler)(TKRGroupUpdateResult* _Nonnull result);
+
 /*!
  @typedef TKRIdentityVerificationHandler
  @brief Block which may be called with a session token string.
@@ -99,6 +136,14 @@ typedef void (^TKRVerificationKeyHandler)(TKRVerificationKey* _Nullable key, NSE
 typedef void (^TKRVerificationMethodsHandler)(NSArray<TKRVerificationMethod*>* _Nullable methods,
                                               NSError* _Nullable err);
 
+/*!
+ @typedef TKRVerificationMethodsChangeHandler
+ @brief Block which will be called when the cached verification methods changed.
+
+ @param methods the new list of verification methods.
+ */
+typedef void (^TKRVerificationMethodsChangeHandler)(NSArray<TKRVerificationMethod*>* _Nonnull methods);
+
 /*!
  @typedef TKRAuthenticateWithIDPResultHandler
  @brief Block which will be called with a TKRVerification*.
@@ -126,6 +171,14 @@ typedef void (^TKRAttachResultHandler)(TKRAttachResult* _Nullable result, NSErro
  */
 typedef void (^TKRInputStreamHandler)(NSInputStream* _Nullable stream, NSError* _Nullable err);
 
+/*!
+ @typedef TKRStreamProgressHandler
+ @brief Block called as the input of an encryption or decryption stream is consumed
+
+ @param processedBytes the number of bytes read from the input stream so far
+ */
+typedef void (^TKRStreamProgressHandler)(uint64_t processedBytes);
+
 /*!
  @typedef TKREncryptionSessionHandler
  @brief Block which will be called with a TKREncryptionSession*.
@@ -0,0 +1,8 @@
+#import <Tanker/TKRDataResult.h>
+
+@interface TKRDataResult ()
+
+@property(nullable, readwrite) NSData* data;
+@property(nullable, readwrite) NSError* error;
+
+@end
@@ -0,0 +1,17 @@
+#import <Foundation/Foundation.h>
+
+/*!
+ @brief Result of a single item of a batch operation
+
+ @description Exactly one of data and error is set.
+ */
+NS_SWIFT_NAME(DataResult)
+@interface TKRDataResult : NSObject
+
+/// The resulting data, or nil if an error occurred for this item.
+@property(nullable, readonly) NSData* data;
+
+/// The error which occurred for this item, or nil.
+@property(nullable, readonly) NSError* error;
+
+@end
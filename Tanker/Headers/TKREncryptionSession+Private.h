@@ -5,6 +5,8 @@
 @interface TKREncryptionSession (Private)
 
 @property(nonnull) void* cSession;
+// Queue on which completion handlers are called, inherited from the TKRTanker which created the session
+@property(nonnull) dispatch_queue_t completionQueue;
 
 - (void)encryptDataImpl:(nonnull NSData*)clearData
       completionHandler:(nonnull void (^)(TKRPtrAndSizePair* _Nullable, NSError* _Nullable err))handler;
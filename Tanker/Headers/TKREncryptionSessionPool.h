@@ -0,0 +1,80 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRCompletionHandlers.h>
+
+@class TKREncryptionOptions;
+@class TKRTanker;
+
+/*!
+ @brief Pool of encryption sessions, shared by encryptions with the same options
+
+ @discussion Sessions are keyed by their recipients, shareWithSelf and padding step. The order of the recipients and
+ duplicated recipients do not matter. A session is rotated after it has been handed out maxUsesPerSession times, or
+ when it is older than maxSessionAge. A fresh session is opened in the background shortly before the rotation, so
+ that the rotation does not cost a round trip.
+
+ Handlers are called on the completion queue of the TKRTanker.
+ */
+NS_SWIFT_NAME(EncryptionSessionPool)
+@interface TKREncryptionSessionPool : NSObject
+
+// MARK: Class methods
+
+/*!
+ @brief Create a pool of encryption sessions opened by tanker.
+
+ @pre tanker status must be TKRStatusReady when sessions are requested.
+ */
++ (nonnull instancetype)poolWithTanker:(nonnull TKRTanker*)tanker;
+
+// MARK: Instance methods
+
+/*!
+ @brief Get a session for options, opening one if there is none to reuse.
+
+ @param options the encryption options of the session.
+ @param handler the block called with the encryption session.
+ */
+- (void)encryptionSessionWithOptions:(nonnull TKREncryptionOptions*)options
+                   completionHandler:(nonnull TKREncryptionSessionHandler)handler;
+
+/*!
+ @brief Encrypt data with a session of the pool.
+
+ @param clearData data to encrypt.
+ @param options the encryption options of the session.
+ @param handler the block called with the encrypted data.
+ */
+- (void)encryptData:(nonnull NSData*)clearData
+              options:(nonnull TKREncryptionOptions*)options
+    completionHandler:(nonnull TKREncryptedDataHandler)handler;
+
+/*!
+ @brief Encrypt a string with a session of the pool.
+
+ @discussion The string will be converted to UTF-8 before encryption.
+
+ @param clearText the string to encrypt.
+ @param options the encryption options of the session.
+ @param handler the block called with the encrypted data.
+ */
+- (void)encryptString:(nonnull NSString*)clearText
+              options:(nonnull TKREncryptionOptions*)options
+    completionHandler:(nonnull TKREncryptedDataHandler)handler;
+
+/*!
+ @brief Forget every session, the next requests open new ones.
+
+ @discussion Sessions already handed out stay usable.
+ */
+- (void)removeAllSessions;
+
+// MARK: Properties
+
+/// Number of times a session is handed out before being rotated, 0 for no limit. Defaults to 1000.
+@property NSUInteger maxUsesPerSession;
+
+/// Age in seconds after which a session is rotated, 0 for no limit. Defaults to 10 minutes.
+@property NSTimeInterval maxSessionAge;
+
+@end
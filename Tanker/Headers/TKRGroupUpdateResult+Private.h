@@ -0,0 +1,10 @@
+#import <Tanker/TKRGroupUpdateResult.h>
+
+@interface TKRGroupUpdateResult ()
+
+@property(nullable, readwrite) NSString* groupID;
+@property(nonnull, readwrite) NSArray<NSString*>* pendingUsersToAdd;
+@property(nonnull, readwrite) NSArray<NSString*>* pendingUsersToRemove;
+@property(nullable, readwrite) NSError* error;
+
+@end
@@ -0,0 +1,20 @@
+#import <Foundation/Foundation.h>
+
+/*!
+ @brief Outcome of a chunked group creation or membership update
+
+ @discussion When an error occurred, the pending identities were not processed, and can be given back to
+ updateMembersOfGroup:usersToAdd:usersToRemove:chunkSize:progressHandler:completionHandler: to resume the update.
+ */
+NS_SWIFT_NAME(GroupUpdateResult)
+@interface TKRGroupUpdateResult : NSObject
+
+/*!
+ @brief ID of the updated group, nil if the group could not be created
+ */
+@property(readonly, nullable) NSString* groupID;
+@property(readonly, nonnull) NSArray<NSString*>* pendingUsersToAdd;
+@property(readonly, nonnull) NSArray<NSString*>* pendingUsersToRemove;
+@property(readonly, nullable) NSError* error;
+
+@end
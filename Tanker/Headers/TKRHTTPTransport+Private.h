@@ -0,0 +1,14 @@
+#import <Foundation/Foundation.h>
+
+// Same as the NSURLSession data task handler, response is a NSHTTPURLResponse when error is nil
+typedef void (^TKRHTTPResponseHandler)(NSData* _Nullable body,
+                                       NSURLResponse* _Nullable response,
+                                       NSError* _Nullable error);
+
+// Sends the HTTP requests of the native layer instead of NSURLSession, e.g. to a stand-in backend.
+// The handler may be called on any thread. It is ignored if the native layer cancelled the request in the meantime.
+@protocol TKRHTTPTransport <NSObject>
+
+- (void)sendRequest:(nonnull NSURLRequest*)request completionHandler:(nonnull TKRHTTPResponseHandler)handler;
+
+@end
@@ -0,0 +1,22 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRCompletionHandlers.h>
+#import <Tanker/TKRLogEntry.h>
+
+#include <Tanker/ctanker.h>
+
+// Native log records go through a bounded lock-free queue, and are given to the log handler on a background serial
+// queue. Records below the minimum level are dropped before anything is copied or allocated.
+
+// Number of records the queue can hold, records are dropped when it is full
+#define TKR_LOG_QUEUE_CAPACITY 256
+
+// Called by the native threads, never blocks
+void TKR_logQueuePush(tanker_log_record_t const* _Nonnull record);
+
+void TKR_logQueueSetHandler(TKRLogHandler _Nonnull handler);
+void TKR_logQueueSetMinimumLevel(TKRLogLevel level);
+TKRLogLevel TKR_logQueueMinimumLevel(void);
+uint64_t TKR_logQueueDroppedCount(void);
+// Waits until every record pushed so far has been handled
+void TKR_logQueueFlush(void);
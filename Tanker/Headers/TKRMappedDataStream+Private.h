@@ -0,0 +1,18 @@
+
+#import <Foundation/Foundation.h>
+
+#include <Tanker/ctanker.h>
+#include <Tanker/ctanker/stream.h>
+
+// Creates a native stream reading from the given source
+typedef tanker_future_t* _Nonnull (^TKRStreamFactory)(tanker_stream_input_source_t _Nonnull source,
+                                                      void* _Nonnull sourceData);
+
+// Runs a native stream over data, writes its output to destination with NSFileProtectionComplete, and gives it as an
+// NSData mapping that file, so that only the pages being accessed are resident. The file is removed on error.
+// makeStream is called before returning, handler is called on queue.
+void TKR_streamDataToFile(NSData* _Nonnull data,
+                          NSURL* _Nonnull destination,
+                          TKRStreamFactory _Nonnull makeStream,
+                          dispatch_queue_t _Nonnull queue,
+                          void (^_Nonnull handler)(NSData* _Nullable, NSError* _Nullable));
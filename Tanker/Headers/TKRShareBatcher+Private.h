@@ -0,0 +1,22 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRCompletionHandlers.h>
+
+@class TKRSharingOptions;
+@class TKRTanker;
+
+// Merges the shares issued to the same recipients within a short window into a single native share
+@interface TKRShareBatcher : NSObject
+
++ (nonnull instancetype)batcherWithTanker:(nonnull TKRTanker*)tanker
+                                 interval:(NSTimeInterval)interval
+                             maxResources:(NSUInteger)maxResources;
+
+- (void)shareResourceIDs:(nonnull NSArray<NSString*>*)resourceIDs
+                 options:(nonnull TKRSharingOptions*)options
+       completionHandler:(nonnull TKRErrorHandler)handler;
+
+// Number of native shares issued so far, including the ones issued after a failed batch
+@property(readonly) NSUInteger nativeShareCount;
+
+@end
@@ -12,4 +12,10 @@
 
 - (nullable instancetype)initWithCStream:(nonnull tanker_stream_t*)cstream
                              asyncReader:(nonnull TKRAsyncStreamReader*)reader;
+
+// Fails the stream with TKRErrorOperationCanceled, and closes the native stream and its input once the read in
+// progress, if any, is over. Must be called on the main queue
+- (void)cancel;
+// Called once, on any thread, when the stream reaches its end, fails, is cancelled or closed
+- (void)setEndHandler:(nonnull dispatch_block_t)handler;
 @end
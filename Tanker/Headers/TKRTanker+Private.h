@@ -2,16 +2,27 @@
 #import <Foundation/Foundation.h>
 
 #import <Tanker/TKRAsyncStreamReader+Private.h>
+#import <Tanker/TKRBulkGroupUpdate+Private.h>
+#import <Tanker/TKRCancellationToken+Private.h>
 #import <Tanker/TKRPadding.h>
+#import <Tanker/TKRShareBatcher+Private.h>
 #import <Tanker/TKRTanker.h>
 #import <Tanker/Utils/TKRUtils.h>
 
 typedef void (^TKRAbstractEventHandler)(void* _Nonnull);
 
+// Wraps the native encryption or decryption stream, which stops reading its input and fails once the token is
+// cancelled
 void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
                            tanker_future_t* _Nonnull streamFut,
+                           TKRCancellationToken* _Nullable token,
+                           dispatch_queue_t _Nonnull queue,
                            TKRInputStreamHandler _Nonnull handler);
 
+// Serial queue on which native instances are destroyed, so that releasing the last reference never blocks.
+// Creations are queued after pending destructions, which may still hold the databases.
+dispatch_queue_t _Nonnull TKR_lifecycleQueue(void);
+
 NSError* _Nullable convertSharingOptions(TKRSharingOptions* _Nonnull opts, void* _Nonnull c_opts);
 NSError* _Nullable convertEncryptionOptions(TKREncryptionOptions* _Nonnull opts, void* _Nonnull c_opts);
 
@@ -20,11 +31,43 @@ NSError* _Nullable convertEncryptionOptions(TKREncryptionOptions* _Nonnull opts,
 // NOTE: Implemented on the Swift side
 @property(nonnull) void* cTanker;
 
+// Queue on which completion handlers are called, the main queue unless set in the options
+// NOTE: Implemented on the Swift side
+@property(nonnull, readonly) dispatch_queue_t completionQueue;
+
+// Drops the cached verification methods
+// NOTE: Implemented on the Swift side
+- (void)resetVerificationMethodCache;
+
+// Public identity of the identity given to start, nil before start
+// NOTE: Implemented on the Swift side
+@property(nullable, readonly) NSString* publicIdentity;
+
+// Group ID -> chunked updates waiting for the running one to finish, guarded by itself
+@property(nonnull, readonly) NSMutableDictionary<NSString*, NSMutableArray<TKRBulkGroupUpdate*>*>* runningGroupUpdates;
+
 - (void)encryptDataImpl:(nonnull NSData*)clearData
                 options:(nonnull TKREncryptionOptions*)options
       completionHandler:(nonnull void (^)(TKRPtrAndSizePair* _Nullable, NSError* _Nullable err))handler;
 
+// Merges shares when shareCoalescingInterval is set in the options, nil otherwise
+@property(nullable, readonly) TKRShareBatcher* shareBatcher;
+
+// Sends a native share right away
+- (void)shareResourceIDsImpl:(nonnull NSArray<NSString*>*)resourceIDs
+                     options:(nonnull TKRSharingOptions*)options
+           completionHandler:(nonnull TKRErrorHandler)handler;
+
 - (void)decryptDataImpl:(nonnull NSData*)encryptedData
       completionHandler:(nonnull void (^)(TKRPtrAndSizePair* _Nullable, NSError* _Nullable err))handler;
 
+// Go through a native stream, and give the result as a memory-mapping of destination
+- (void)encryptDataImpl:(nonnull NSData*)clearData
+            toFileAtURL:(nonnull NSURL*)destination
+                options:(nonnull TKREncryptionOptions*)options
+      completionHandler:(nonnull TKREncryptedDataHandler)handler;
+- (void)decryptDataImpl:(nonnull NSData*)encryptedData
+            toFileAtURL:(nonnull NSURL*)destination
+      completionHandler:(nonnull TKRDecryptedDataHandler)handler;
+
 @end
@@ -2,7 +2,11 @@
 #import <AvailabilityMacros.h>
 #import <Foundation/Foundation.h>
 
+#import <Tanker/TKRCancellationToken.h>
 #import <Tanker/TKRCompletionHandlers.h>
+#import <Tanker/TKRDataResult.h>
+#import <Tanker/TKRGroupUpdateResult.h>
+#import <Tanker/TKRLogEntry.h>
 #import <Tanker/TKRStatus.h>
 #import <Tanker/TKRTankerOptions.h>
 #import <Tanker/TKRVerificationKey.h>
@@ -34,6 +38,18 @@ NS_SWIFT_NAME(Tanker)
 + (nullable TKRTanker*)tankerWithOptions:(nonnull TKRTankerOptions*)options
                                    error:(NSError* _Nullable* _Nullable)errResult;
 
+/*!
+ @brief Create a TKRTanker object with options, without blocking the calling thread.
+
+ @discussion Creating a TKRTanker opens its databases, which can take a while. Prefer this method on the main thread.
+
+ @param options Options needed to initialize Tanker.
+ @param handler the block called with the TKRTanker, or an NSError* filled with TKRErrorInvalidArgument.
+
+ @pre Every field must be set with a valid value.
+ */
++ (void)tankerWithOptions:(nonnull TKRTankerOptions*)options completionHandler:(nonnull TKRTankerHandler)handler;
+
 /*!
  @brief Get Tanker version as a string
  */
@@ -47,8 +63,27 @@ NS_SWIFT_NAME(Tanker)
                                       publicKey:(nonnull NSString*)publicKey
                                           error:(NSError* _Nullable* _Nullable)errResult;
 
+/*!
+ @brief Set the handler receiving the SDK logs
+
+ @discussion The handler is called on a background serial queue, never on the thread that emitted the log. Unless a
+ minimum level was set, connecting a handler enables every log level.
+ */
 + (void)connectLogHandler:(nonnull TKRLogHandler)handler;
 
+/*!
+ @brief Set the minimum level of the logs given to the log handler
+
+ @discussion Logs below this level are discarded before being copied. Defaults to TKRLogLevelError until a log handler
+ is connected.
+ */
++ (void)setMinimumLogLevel:(TKRLogLevel)level;
+
+/*!
+ @brief Get the number of logs dropped because the log handler could not keep up
+ */
++ (uint64_t)droppedLogCount;
+
 // MARK: Instance methods
 
 /*!
@@ -60,6 +95,20 @@ NS_SWIFT_NAME(Tanker)
  */
 - (void)verificationMethodsWithCompletionHandler:(nonnull TKRVerificationMethodsHandler)handler;
 
+/*!
+ @brief Get the list of the registered verification methods, from a local cache when possible.
+
+ @discussion The first call fetches the methods from the server. Later calls complete right away with the cached
+ methods, and refresh them in the background once they are older than the verificationMethodCacheMaxAge option. The
+ cache is invalidated by setVerificationMethodWithVerification, and cleared by stop. Set
+ verificationMethodsChangeHandler to be notified when a refresh returns different methods.
+
+ @pre status must be TKRStatusReady
+
+ @param handler the block called with a list of registered verification methods, or an NSError*.
+ */
+- (void)cachedVerificationMethodsWithCompletionHandler:(nonnull TKRVerificationMethodsHandler)handler;
+
 /*!
  @brief Register or update a verification method.
 
@@ -267,6 +316,116 @@ NS_SWIFT_NAME(Tanker)
  */
 - (void)decryptData:(nonnull NSData*)encryptedData completionHandler:(nonnull TKRDecryptedDataHandler)handler;
 
+/*!
+ @brief Encrypt data chunk by chunk into a file, and share it with the user's registered devices.
+
+ @discussion equivalent to calling encryptData:toFileAtURL:options: with default options.
+
+ @param clearData data to encrypt.
+ @param destination the file to write the encrypted data to.
+ @param handler the block called with the encrypted data, mapping the destination file.
+ */
+- (void)encryptData:(nonnull NSData*)clearData
+          toFileAtURL:(nonnull NSURL*)destination
+    completionHandler:(nonnull TKREncryptedDataHandler)handler;
+
+/*!
+ @brief Encrypt data chunk by chunk into a file, using customized options.
+
+ @discussion The data is encrypted in the stream format, like encryptStream, and only a few chunks of it are resident
+ at once, which suits large or memory-mapped data. An existing destination file is replaced. The result maps the
+ destination file, which must not be modified while the data is in use.
+
+ @param clearData data to encrypt.
+ @param destination the file to write the encrypted data to.
+ @param options custom encryption options.
+ @param handler the block called with the encrypted data, mapping the destination file.
+ */
+- (void)encryptData:(nonnull NSData*)clearData
+          toFileAtURL:(nonnull NSURL*)destination
+              options:(nonnull TKREncryptionOptions*)options
+    completionHandler:(nonnull TKREncryptedDataHandler)handler;
+
+/*!
+ @brief Decrypt data chunk by chunk into a file.
+
+ @discussion Only a few chunks of the decrypted data are resident at once, which suits large or memory-mapped data.
+ The destination file is created with NSFileProtectionComplete, an existing one is replaced, and it is removed if
+ decryption fails. The result maps the destination file, which must not be modified while the data is in use.
+
+ @param encryptedData encrypted data to decrypt.
+ @param destination the file to write the decrypted data to.
+ @param handler the block called with the decrypted data, mapping the destination file.
+ */
+- (void)decryptData:(nonnull NSData*)encryptedData
+          toFileAtURL:(nonnull NSURL*)destination
+    completionHandler:(nonnull TKRDecryptedDataHandler)handler;
+
+/*!
+ @brief Encrypt multiple data and share them with the user's registered devices.
+
+ @discussion equivalent to calling encryptDataBatch:options: with default options.
+
+ @param clearData data to encrypt.
+ @param handler the block called once with the encrypted data, or an error, for each item.
+ */
+- (void)encryptDataBatch:(nonnull NSArray<NSData*>*)clearData completionHandler:(nonnull TKRBatchDataHandler)handler;
+
+/*!
+ @brief Encrypt multiple data, using customized options.
+
+ @discussion Every item is encrypted with the same options. Items are processed concurrently, and the handler is called
+ only once.
+
+ @param clearData data to encrypt.
+ @param options custom encryption options.
+ @param handler the block called once with the encrypted data, or an error, for each item.
+ */
+- (void)encryptDataBatch:(nonnull NSArray<NSData*>*)clearData
+                 options:(nonnull TKREncryptionOptions*)options
+       completionHandler:(nonnull TKRBatchDataHandler)handler;
+
+/*!
+ @brief Decrypt multiple encrypted data.
+
+ @discussion Items are processed concurrently, and the handler is called only once. A failure to decrypt one item does
+ not prevent the others from being decrypted.
+
+ @param encryptedData encrypted data to decrypt.
+ @param handler the block called once with the decrypted data, or an error, for each item.
+ */
+- (void)decryptDataBatch:(nonnull NSArray<NSData*>*)encryptedData
+       completionHandler:(nonnull TKRBatchDataHandler)handler;
+
+/*!
+ @brief Encrypt multiple data, stopping early once the token is cancelled.
+
+ @discussion The items which are not encrypted yet when the token is cancelled get a TKRErrorOperationCanceled error,
+ and the handler is called right away.
+
+ @param clearData data to encrypt.
+ @param options custom encryption options.
+ @param token the token cancelling the batch, can be shared with other operations.
+ @param handler the block called once with the encrypted data, or an error, for each item.
+ */
+- (void)encryptDataBatch:(nonnull NSArray<NSData*>*)clearData
+                 options:(nonnull TKREncryptionOptions*)options
+       cancellationToken:(nullable TKRCancellationToken*)token
+       completionHandler:(nonnull TKRBatchDataHandler)handler;
+
+/*!
+ @brief Decrypt multiple encrypted data, stopping early once the token is cancelled.
+
+ @discussion see encryptDataBatch:options:cancellationToken:completionHandler:.
+
+ @param encryptedData encrypted data to decrypt.
+ @param token the token cancelling the batch, can be shared with other operations.
+ @param handler the block called once with the decrypted data, or an error, for each item.
+ */
+- (void)decryptDataBatch:(nonnull NSArray<NSData*>*)encryptedData
+       cancellationToken:(nullable TKRCancellationToken*)token
+       completionHandler:(nonnull TKRBatchDataHandler)handler;
+
 /*!
  @brief Get the encrypted resource ID.
 
@@ -311,6 +470,88 @@ NS_SWIFT_NAME(Tanker)
                usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
            completionHandler:(nonnull TKRErrorHandler)handler;
 
+/*!
+ @brief Create a group with a large number of identities, in chunks.
+
+ @discussion The group is created with the first chunk, the other chunks are then added one at a time, so that the
+ memory used does not depend on the number of identities. Only group members can add the other chunks: when there is
+ more than one chunk, identities must contain the public identity of the current user, which is sent with the first
+ chunk, or the result has a TKRErrorInvalidArgument error.
+
+ @param identities the identities to add to the group.
+ @param chunkSize the maximum number of identities sent at once, defaults to 1000 when 0.
+ @param progressHandler the block called after each chunk, or nil.
+ @param handler the block called with the group ID, and the identities left to add if an error occurred.
+ */
+- (void)createGroupWithIdentities:(nonnull NSArray<NSString*>*)identities
+                        chunkSize:(NSUInteger)chunkSize
+                  progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+                completionHandler:(nonnull TKRGroupUpdateResultHandler)handler;
+
+/*!
+ @brief Add and/or remove a large number of users of a group, in chunks.
+
+ @discussion Chunks are sent one at a time, and chunked updates of the same group are run one after the other. When a
+ chunk fails, the update stops, and the result contains the users that were not processed, which can be given back to
+ this method to resume the update.
+
+ @param groupId the id of the group to update.
+ @param usersToAdd the users to add to the group.
+ @param usersToRemove the users to remove from the group.
+ @param chunkSize the maximum number of users sent at once, defaults to 1000 when 0.
+ @param progressHandler the block called after each chunk, or nil.
+ @param handler the block called with the users left to process if an error occurred.
+ */
+- (void)updateMembersOfGroup:(nonnull NSString*)groupId
+                  usersToAdd:(nonnull NSArray<NSString*>*)usersToAdd
+               usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
+                   chunkSize:(NSUInteger)chunkSize
+             progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+           completionHandler:(nonnull TKRGroupUpdateResultHandler)handler;
+
+/*!
+ @brief Create a group with a large number of identities, in chunks, stopping after the current chunk once the token is
+ cancelled.
+
+ @discussion The result then has a TKRErrorOperationCanceled error, and the identities left to add. If the group was
+ already created, they can be given to updateMembersOfGroup to resume. As with
+ createGroupWithIdentities:chunkSize:progressHandler:completionHandler:, identities must contain the public identity of
+ the current user when there is more than one chunk.
+
+ @param identities the identities to add to the group.
+ @param chunkSize the maximum number of identities sent at once, defaults to 1000 when 0.
+ @param token the token cancelling the creation, can be shared with other operations.
+ @param progressHandler the block called after each chunk, or nil.
+ @param handler the block called with the group ID, and the identities left to add if an error occurred.
+ */
+- (void)createGroupWithIdentities:(nonnull NSArray<NSString*>*)identities
+                        chunkSize:(NSUInteger)chunkSize
+                cancellationToken:(nullable TKRCancellationToken*)token
+                  progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+                completionHandler:(nonnull TKRGroupUpdateResultHandler)handler;
+
+/*!
+ @brief Add and/or remove a large number of users of a group, in chunks, stopping after the current chunk once the
+ token is cancelled.
+
+ @discussion The result then has a TKRErrorOperationCanceled error, and the users left to process.
+
+ @param groupId the id of the group to update.
+ @param usersToAdd the users to add to the group.
+ @param usersToRemove the users to remove from the group.
+ @param chunkSize the maximum number of users sent at once, defaults to 1000 when 0.
+ @param token the token cancelling the update, can be shared with other operations.
+ @param progressHandler the block called after each chunk, or nil.
+ @param handler the block called with the users left to process if an error occurred.
+ */
+- (void)updateMembersOfGroup:(nonnull NSString*)groupId
+                  usersToAdd:(nonnull NSArray<NSString*>*)usersToAdd
+               usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
+                   chunkSize:(NSUInteger)chunkSize
+           cancellationToken:(nullable TKRCancellationToken*)token
+             progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+           completionHandler:(nonnull TKRGroupUpdateResultHandler)handler;
+
 /*!
  @brief Authenticates against a trusted identity provider.
 
@@ -386,6 +627,40 @@ NS_SWIFT_NAME(Tanker)
  */
 - (void)decryptStream:(nonnull NSInputStream*)encryptedStream completionHandler:(nonnull TKRInputStreamHandler)handler;
 
+/*!
+ @brief Create an encryption stream which can be cancelled, and reports how much of the input it consumed.
+
+ @discussion once the token is cancelled, the input stream is closed and reading the encryption stream fails with
+ TKRErrorOperationCanceled. The handler gets that error instead of the stream if it was not created yet.
+
+ @param clearStream the stream to encrypt.
+ @param opts custom encryption options.
+ @param token the token cancelling the encryption, can be shared with other operations.
+ @param progressHandler the block called with the total number of bytes read from clearStream, on the completion queue.
+ @param handler the block called with the encryption stream.
+ */
+- (void)encryptStream:(nonnull NSInputStream*)clearStream
+              options:(nonnull TKREncryptionOptions*)opts
+    cancellationToken:(nullable TKRCancellationToken*)token
+      progressHandler:(nullable TKRStreamProgressHandler)progressHandler
+    completionHandler:(nonnull TKRInputStreamHandler)handler;
+
+/*!
+ @brief Create a decryption stream which can be cancelled, and reports how much of the input it consumed.
+
+ @discussion see encryptStream:options:cancellationToken:progressHandler:completionHandler:.
+
+ @param encryptedStream the stream to decrypt.
+ @param token the token cancelling the decryption, can be shared with other operations.
+ @param progressHandler the block called with the total number of bytes read from encryptedStream, on the completion
+ queue.
+ @param handler the block called with the decryption stream.
+ */
+- (void)decryptStream:(nonnull NSInputStream*)encryptedStream
+    cancellationToken:(nullable TKRCancellationToken*)token
+      progressHandler:(nullable TKRStreamProgressHandler)progressHandler
+    completionHandler:(nonnull TKRInputStreamHandler)handler;
+
 - (void)dealloc;
 
 // MARK: Properties
@@ -396,4 +671,12 @@ NS_SWIFT_NAME(Tanker)
 /// Current Tanker status
 @property(readonly) TKRStatus status;
 
+/*!
+ @brief Optional. Block called on the completion queue when a refresh of the cached verification methods returns
+ different methods.
+
+ @see cachedVerificationMethodsWithCompletionHandler:
+ */
+@property(nullable, copy) TKRVerificationMethodsChangeHandler verificationMethodsChangeHandler;
+
 @end
@@ -1,9 +1,12 @@
 
 #import <Foundation/Foundation.h>
+#import <Tanker/TKRHTTPTransport+Private.h>
 #import <Tanker/TKRTankerOptions.h>
 
 @interface TKRTankerOptions (Private)
 
 @property NSString* sdkType;
+// Replaces NSURLSession for the requests of this instance, nil by default
+@property(nullable) id<TKRHTTPTransport> httpTransport;
 
 @end
@@ -33,6 +33,47 @@ NS_SWIFT_NAME(TankerOptions)
 
 @property NSString* sdkType;
 
+/*!
+ @brief Optional. Queue on which every completion handler is called.
+
+ @discussion Defaults to the main queue. Use a background queue to avoid contending with the UI when the SDK is used
+ from background code.
+ */
+@property dispatch_queue_t completionQueue;
+
+/*!
+ @brief Optional. Window during which shareResourceIDs:options:completionHandler: calls are merged.
+
+ @discussion Defaults to 0, which sends every share immediately. When set, shares to the same recipients issued within
+ this window are sent as a single request, and each caller still gets its own completion.
+ */
+@property NSTimeInterval shareCoalescingInterval;
+
+/*!
+ @brief Optional. Maximum number of resource IDs in a merged share.
+
+ @discussion A merged share is sent as soon as it reaches this size. Defaults to 100 when set to 0.
+ */
+@property NSUInteger shareCoalescingMaxResources;
+
+/*!
+ @brief Optional. Maximum delay before cached keys are written to disk.
+
+ @discussion Defaults to 0, which writes every cache update synchronously. When set, cache updates are kept in memory
+ and written in grouped transactions at most this many seconds later, which saves disk syncs during session start and
+ large syncs. Cached data lost on a crash is fetched again from the server. Device data is always written synchronously.
+ Instances alive at the same time with the same cachePath must use the same value, creating one fails otherwise.
+ */
+@property NSTimeInterval datastoreWriteBehindDelay;
+
+/*!
+ @brief Optional. Time during which cached verification methods are returned without being refreshed.
+
+ @discussion Defaults to 60 seconds when set to 0. Older cached methods are still returned right away by
+ cachedVerificationMethodsWithCompletionHandler:, and refreshed in the background.
+ */
+@property NSTimeInterval verificationMethodCacheMaxAge;
+
 /*!
   @brief Create and return an empty TKRTankerOptions.
  */
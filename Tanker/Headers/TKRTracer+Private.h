@@ -0,0 +1,63 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRTracer.h>
+#import <Tanker/Utils/TKRUtils.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Trace points must check TKR_traceEnabled() before doing anything else, so that disabled tracing costs one branch.
+extern atomic_bool TKR_tracingEnabled;
+
+static inline bool TKR_traceEnabled(void)
+{
+  return atomic_load_explicit(&TKR_tracingEnabled, memory_order_relaxed);
+}
+
+// Monotonic clock, in nanoseconds
+uint64_t TKR_traceNow(void);
+// name must be a string literal, or live as long as the process
+void TKR_traceRecordSpan(char const* _Nonnull name, uint64_t operationID, uint64_t start, uint64_t end);
+
+// Starts an operation on the current thread. It is picked up by the next TKR_bridgeAdapter or TKR_runOnQueue call
+// on this thread, which respectively traces the native call or the early completion of the operation.
+void TKR_traceBeginOperation(char const* _Nonnull name);
+// Called by TKR_bridgeAdapter when tracing is enabled
+void* _Nonnull TKR_traceBridgeAdapter(TKRAdapter _Nonnull adapter, dispatch_queue_t _Nullable queue);
+// Called by TKR_runOnQueue when tracing is enabled
+void (^_Nonnull TKR_traceCompletion(void (^_Nonnull block)(void)))(void);
+
+#define TKR_TRACE_OPERATION()            \
+  do                                     \
+  {                                      \
+    if (TKR_traceEnabled())              \
+      TKR_traceBeginOperation(__func__); \
+  } while (0)
+
+// Drops the operation started on the current thread
+void TKR_traceClearOperation(void);
+
+// Must be used by operations completing without TKR_bridgeAdapter nor TKR_runOnQueue, e.g. calling their handler
+// right away on invalid arguments, so that the next native call on this thread is not attributed to them
+#define TKR_TRACE_CLEAR_OPERATION() \
+  do                                \
+  {                                 \
+    if (TKR_traceEnabled())         \
+      TKR_traceClearOperation();    \
+  } while (0)
+
+// Runs statement, recorded as a span outside of any operation. When tracing is disabled, the statement runs after a
+// single check of the flag.
+#define TKR_TRACE_SPAN(name, statement)                                \
+  do                                                                   \
+  {                                                                    \
+    if (TKR_traceEnabled())                                            \
+    {                                                                  \
+      uint64_t const TKR_traceSpanStart = TKR_traceNow();              \
+      statement;                                                       \
+      TKR_traceRecordSpan(name, 0, TKR_traceSpanStart, TKR_traceNow()); \
+    }                                                                  \
+    else                                                               \
+      statement;                                                       \
+  } while (0)
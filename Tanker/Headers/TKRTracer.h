@@ -0,0 +1,90 @@
+#import <Foundation/Foundation.h>
+
+/*!
+ @brief Distribution of the durations recorded for one span name
+ */
+NS_SWIFT_NAME(TraceHistogram)
+@interface TKRTraceHistogram : NSObject
+
+/*!
+ @brief Number of recorded spans.
+ */
+@property(readonly) NSUInteger count;
+
+/*!
+ @brief Shortest recorded duration, in seconds.
+ */
+@property(readonly) NSTimeInterval min;
+
+/*!
+ @brief Longest recorded duration, in seconds.
+ */
+@property(readonly) NSTimeInterval max;
+
+/*!
+ @brief Mean of the recorded durations, in seconds.
+ */
+@property(readonly) NSTimeInterval mean;
+
+/*!
+ @brief Duration below which the given fraction of the spans are, in seconds.
+
+ @discussion Durations are bucketed with a precision of about 20%.
+
+ @param fraction between 0 and 1, e.g. 0.99 for the 99th percentile.
+ */
+- (NSTimeInterval)percentile:(double)fraction;
+
+@end
+
+/*!
+ @brief Opt-in latency tracing of the SDK operations
+
+ @discussion When enabled, each operation of TKRTanker and TKREncryptionSession gets an id, and the following spans are
+ recorded with it:
+ - the operation itself, until its completion handler returns
+ - "marshalling": conversion of the arguments, until the native call is made
+ - "native": the native operation, until its result is available
+ - "completion": the hop to the completion queue
+
+ Datastore callbacks ("datastore.*") and HTTP requests ("http") are recorded on the thread they run on. They are made by
+ the native layer, and are not attributed to an operation.
+
+ When tracing is disabled, the cost of each trace point is a flag check.
+ */
+NS_SWIFT_NAME(Tracer)
+@interface TKRTracer : NSObject
+
+// MARK: Class methods
+
+/*!
+ @brief Start or stop recording spans.
+
+ @discussion Recorded spans are kept until reset is called.
+ */
++ (void)setEnabled:(BOOL)enabled;
+
+/*!
+ @brief Whether spans are being recorded.
+ */
++ (BOOL)isEnabled;
+
+/*!
+ @brief Discard the recorded spans and histograms.
+ */
++ (void)reset;
+
+/*!
+ @brief Export the recorded spans in the Chrome trace-event format.
+
+ @discussion The result can be loaded in chrome://tracing or https://ui.perfetto.dev. At most 100000 spans are kept,
+ later ones are only counted in the histograms.
+ */
++ (nonnull NSData*)chromeTraceJSON;
+
+/*!
+ @brief Duration histograms of the recorded spans, by span name.
+ */
++ (nonnull NSDictionary<NSString*, TKRTraceHistogram*>*)histograms;
+
+@end
@@ -26,15 +26,24 @@ NS_SWIFT_NAME(Adapter)
 typedef void (^TKRAdapter)(NSNumber* _Nullable ptrValue, NSError* _Nullable err);
 
 void TKR_runOnMainQueue(void (^_Nonnull block)(void));
+void TKR_runOnQueue(dispatch_queue_t _Nonnull queue, void (^_Nonnull block)(void));
+// Frees an array returned by TKR_convertStringstoCStrings
 void TKR_freeCStringArray(char* _Nonnull* _Nonnull toFree, NSUInteger nbElems);
 NSError* _Nonnull TKR_createNSError(NSUInteger code, NSString* _Nonnull message);
 NSError* _Nonnull TKR_createNSErrorWithDomain(NSString* _Nonnull domain, NSUInteger code, NSString* _Nonnull message);
 NSNumber* _Nonnull TKR_ptrToNumber(void* _Nonnull ptr);
 void* _Nonnull TKR_numberToPtr(NSNumber* _Nonnull nb);
 NSError* _Nullable TKR_getOptionalFutureError(void* _Nonnull future);
+// Returns the arg to give to TKR_resolvePromise, adapter will be called on queue, or inline if queue is nil
+void* _Nonnull TKR_bridgeAdapter(TKRAdapter _Nonnull adapter, dispatch_queue_t _Nullable queue);
 void* _Nullable TKR_resolvePromise(void* _Nonnull future, void* _Nullable arg);
+// Starts a traced operation if tracing is enabled, for Swift code which cannot use TKR_TRACE_OPERATION
+void TKR_traceOperation(char const* _Nonnull name);
 void* _Nullable TKR_unwrapAndFreeExpected(void* _Nonnull expected, NSError* _Nullable* _Nonnull err);
 char* _Nullable TKR_copyUTF8CString(NSString* _Nonnull str, NSError* _Nullable* _Nonnull err);
 NSData* _Nullable TKR_convertStringToData(NSString* _Nonnull clearText, NSError* _Nullable* _Nonnull err);
+// Error of decryptString when the decrypted data is not UTF-8
+NSError* _Nonnull TKR_createDecodingError(void);
+// The array and its strings are a single allocation
 char* _Nonnull* _Nullable TKR_convertStringstoCStrings(NSArray<NSString*>* _Nonnull strings,
                                                        NSError* _Nullable* _Nonnull err);
@@ -0,0 +1,589 @@
+// https://github.com/Specta/Specta
+
+#import <Tanker/Tanker-Swift.h>
+
+#import <Tanker/TKRTanker.h>
+#import <Tanker/TKRTankerOptions+Private.h>
+#import <Tanker/TKRTankerOptions.h>
+
+#import <Tanker/Utils/TKRUtils.h>
+
+#import "TKRReplayBackend.h"
+#import "TKRScenarioRunner.h"
+#import "TKRTestAdmin.h"
+#import "TKRTestAsyncStreamReader.h"
+
+#import <Expecta/Expecta.h>
+#import <PromiseKit/PromiseKit.h>
+#import <Specta/Specta.h>
+
+#include <Tanker/ctanker.h>
+#include <Tanker/ctanker/identity.h>
+
+// Runs the benchmark scenarios against recorded server responses, without network access.
+//
+// TANKER_BENCHMARKS_FIXTURES is a directory containing:
+// - fixture.json: the app, identities and resources the scenarios use
+// - storage/: the persistent and cache storage of a started device of the fixture user
+// - recordings/: the server responses of each scenario
+//
+// With TANKER_BENCHMARKS_RECORD=1, the fixtures are created from scratch against the server of the TANKER_APPD_URL and
+// TANKER_MANAGEMENT_API_* variables. The identity of the fixture user is saved in fixture.json, the app is deleted at
+// the end of the run.
+//
+// No fixtures are committed, they hold an app secret and identities. To bootstrap a set, run the OfflineBenchmarks test
+// spec once with TANKER_BENCHMARKS_RECORD=1, TANKER_BENCHMARKS_FIXTURES pointing to an empty directory and the admin
+// variables of the functional tests set, then keep that directory for the later runs. When
+// TANKER_BENCHMARKS_FIXTURES is not set, the benchmarks are reported as pending.
+//
+// Results are written as JSON to TANKER_BENCHMARKS_RESULTS, or to tanker-benchmarks.json in the temporary directory.
+// Payload sizes above TANKER_BENCHMARKS_MAX_SIZE bytes are skipped.
+
+typedef TKRTanker* _Nonnull (^TKRScenarioSetUp)(id<TKRHTTPTransport> _Nonnull transport);
+typedef void (^TKRScenarioBlock)(TKRTanker* _Nonnull tanker);
+
+static NSString* createIdentity(NSString* userID, NSString* appID, NSString* appSecret)
+{
+  char const* user_id = [userID cStringUsingEncoding:NSUTF8StringEncoding];
+  char const* app_id = [appID cStringUsingEncoding:NSUTF8StringEncoding];
+  char const* app_secret = [appSecret cStringUsingEncoding:NSUTF8StringEncoding];
+  tanker_expected_t* identity_expected = tanker_create_identity(app_id, app_secret, user_id);
+
+  NSError* err = nil;
+  char* identity = TKR_unwrapAndFreeExpected(identity_expected, &err);
+  assert(!err);
+  assert(identity);
+  return [[NSString alloc] initWithBytesNoCopy:identity
+                                        length:strlen(identity)
+                                      encoding:NSUTF8StringEncoding
+                                  freeWhenDone:YES];
+}
+
+static NSString* getPublicIdentity(NSString* identity)
+{
+  tanker_expected_t* identity_expected =
+      tanker_get_public_identity([identity cStringUsingEncoding:NSUTF8StringEncoding]);
+
+  NSError* err = nil;
+  char* public_identity = TKR_unwrapAndFreeExpected(identity_expected, &err);
+  assert(!err);
+  assert(public_identity);
+  return [[NSString alloc] initWithBytesNoCopy:public_identity
+                                        length:strlen(public_identity)
+                                      encoding:NSUTF8StringEncoding
+                                  freeWhenDone:YES];
+}
+
+static NSString* createStorageFullpath(NSSearchPathDirectory dir)
+{
+  NSArray* paths = NSSearchPathForDirectoriesInDomains(dir, NSUserDomainMask, YES);
+  NSString* path = [[paths objectAtIndex:0] stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  NSError* err;
+  BOOL success = [[NSFileManager defaultManager] createDirectoryAtPath:path
+                                           withIntermediateDirectories:YES
+                                                            attributes:nil
+                                                                 error:&err];
+  assert(success);
+  return path;
+}
+
+static NSString* copyStorage(NSString* snapshot, NSSearchPathDirectory dir)
+{
+  NSArray* paths = NSSearchPathForDirectoriesInDomains(dir, NSUserDomainMask, YES);
+  NSString* path = [[paths objectAtIndex:0] stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  NSError* err;
+  BOOL success = [[NSFileManager defaultManager] copyItemAtPath:snapshot toPath:path error:&err];
+  assert(success);
+  return path;
+}
+
+static id hangWithAdapter(void (^handler)(PMKAdapter))
+{
+  return [PMKPromise hang:[PMKPromise promiseWithAdapter:^(PMKAdapter adapter) {
+                       handler(adapter);
+                     }]];
+}
+
+static id hangWithResolver(void (^handler)(PMKResolver))
+{
+  return [PMKPromise hang:[PMKPromise promiseWithResolver:^(PMKResolver resolve) {
+                       handler(resolve);
+                     }]];
+}
+
+static void startTanker(TKRTanker* tanker, NSString* identity)
+{
+  NSError* err = hangWithResolver(^(PMKResolver resolve) {
+    [tanker startWithIdentity:identity
+            completionHandler:^(TKRStatus status, NSError* err) {
+              if (err)
+                resolve(err);
+              else if (status == TKRStatusIdentityRegistrationNeeded)
+                [tanker registerIdentityWithVerification:[[TKRVerification alloc] withPassphrase:@"passphrase"]
+                                       completionHandler:resolve];
+              else
+                resolve(nil);
+            }];
+  });
+  assert(!err);
+  // identity verification is needed when the fixture storage was not reused
+  assert(tanker.status == TKRStatusReady);
+}
+
+static void stopTanker(TKRTanker* tanker)
+{
+  hangWithResolver(^(PMKResolver resolve) {
+    [tanker stopWithCompletionHandler:resolve];
+  });
+}
+
+static TKRTanker* startLiveTanker(NSString* url, NSString* appID, NSString* identity, NSString* storage)
+{
+  TKRTankerOptions* opts = [TKRTankerOptions options];
+  opts.url = url;
+  opts.appID = appID;
+  opts.persistentPath = storage ? [storage stringByAppendingPathComponent:@"persistent"]
+                                : createStorageFullpath(NSLibraryDirectory);
+  opts.cachePath =
+      storage ? [storage stringByAppendingPathComponent:@"cache"] : createStorageFullpath(NSCachesDirectory);
+  opts.sdkType = @"sdk-ios-benchmarks";
+  TKRTanker* tanker = [TKRTanker tankerWithOptions:opts error:nil];
+  assert(tanker);
+  startTanker(tanker, identity);
+  return tanker;
+}
+
+// A fresh copy of the fixture storage, with or without its cache, whose requests go to the transport
+static TKRTankerOptions* fixtureOptions(NSDictionary* fixture, BOOL withCache, id<TKRHTTPTransport> transport)
+{
+  NSString* storage = [fixture[@"directory"] stringByAppendingPathComponent:@"storage"];
+  TKRTankerOptions* opts = [TKRTankerOptions options];
+  opts.url = fixture[@"url"];
+  opts.appID = fixture[@"appID"];
+  opts.persistentPath = copyStorage([storage stringByAppendingPathComponent:@"persistent"], NSLibraryDirectory);
+  opts.cachePath = withCache ? copyStorage([storage stringByAppendingPathComponent:@"cache"], NSCachesDirectory)
+                             : createStorageFullpath(NSCachesDirectory);
+  opts.sdkType = @"sdk-ios-benchmarks";
+  opts.httpTransport = transport;
+  return opts;
+}
+
+static TKRTanker* startFixtureTanker(NSDictionary* fixture, BOOL withCache, id<TKRHTTPTransport> transport)
+{
+  TKRTanker* tanker = [TKRTanker tankerWithOptions:fixtureOptions(fixture, withCache, transport) error:nil];
+  assert(tanker);
+  startTanker(tanker, fixture[@"identity"]);
+  return tanker;
+}
+
+static NSData* encryptData(TKRTanker* tanker, NSData* clearData)
+{
+  id encrypted = hangWithAdapter(^(PMKAdapter adapter) {
+    [tanker encryptData:clearData completionHandler:adapter];
+  });
+  assert([encrypted isKindOfClass:[NSData class]]);
+  return encrypted;
+}
+
+static NSData* decryptData(TKRTanker* tanker, NSData* encryptedData)
+{
+  id decrypted = hangWithAdapter(^(PMKAdapter adapter) {
+    [tanker decryptData:encryptedData completionHandler:adapter];
+  });
+  assert([decrypted isKindOfClass:[NSData class]]);
+  return decrypted;
+}
+
+static NSData* readStream(NSInputStream* stream)
+{
+  TKRTestAsyncStreamReader* reader = [[TKRTestAsyncStreamReader alloc] init];
+  id data = [PMKPromise hang:[reader readAll:stream]];
+  assert([data isKindOfClass:[NSData class]]);
+  return data;
+}
+
+static NSData* createPayload(NSUInteger size)
+{
+  NSMutableData* payload = [NSMutableData dataWithLength:size];
+  arc4random_buf(payload.mutableBytes, size);
+  return payload;
+}
+
+// Creates the fixture user and its storage, the other users and the resources the scenarios need
+static NSDictionary* createFixtures(NSString* directory, NSString* url, NSString* appID, NSString* appSecret)
+{
+  NSFileManager* fileManager = [NSFileManager defaultManager];
+  NSString* storage = [directory stringByAppendingPathComponent:@"storage"];
+  [fileManager removeItemAtPath:storage error:nil];
+  for (NSString* subdirectory in @[ @"storage/persistent", @"storage/cache", @"recordings" ])
+  {
+    BOOL success = [fileManager createDirectoryAtPath:[directory stringByAppendingPathComponent:subdirectory]
+                          withIntermediateDirectories:YES
+                                           attributes:nil
+                                                error:nil];
+    assert(success);
+  }
+
+  NSString* aliceIdentity = createIdentity([[NSUUID UUID] UUIDString], appID, appSecret);
+  NSString* bobIdentity = createIdentity([[NSUUID UUID] UUIDString], appID, appSecret);
+  NSString* carolIdentity = createIdentity([[NSUUID UUID] UUIDString], appID, appSecret);
+  NSString* alicePublicIdentity = getPublicIdentity(aliceIdentity);
+  NSString* bobPublicIdentity = getPublicIdentity(bobIdentity);
+
+  TKRTanker* alice = startLiveTanker(url, appID, aliceIdentity, storage);
+  TKRTanker* bob = startLiveTanker(url, appID, bobIdentity, nil);
+  TKRTanker* carol = startLiveTanker(url, appID, carolIdentity, nil);
+
+  NSString* groupID = hangWithAdapter(^(PMKAdapter adapter) {
+    [alice createGroupWithIdentities:@[ alicePublicIdentity, bobPublicIdentity ] completionHandler:adapter];
+  });
+  assert([groupID isKindOfClass:[NSString class]]);
+
+  // encrypted by bob, so that alice's storage does not have its key
+  TKREncryptionOptions* encryptionOptions = [[TKREncryptionOptions alloc] init];
+  encryptionOptions.shareWithUsers = @[ alicePublicIdentity ];
+  NSData* encrypted = hangWithAdapter(^(PMKAdapter adapter) {
+    [bob encryptData:createPayload(1024) options:encryptionOptions completionHandler:adapter];
+  });
+  assert([encrypted isKindOfClass:[NSData class]]);
+
+  stopTanker(alice);
+  stopTanker(bob);
+  stopTanker(carol);
+
+  NSDictionary* fixture = @{
+    @"url" : url,
+    @"appID" : appID,
+    @"identity" : aliceIdentity,
+    @"publicIdentity" : alicePublicIdentity,
+    @"bobPublicIdentity" : bobPublicIdentity,
+    @"carolPublicIdentity" : getPublicIdentity(carolIdentity),
+    @"groupID" : groupID,
+    @"encrypted" : [encrypted base64EncodedStringWithOptions:0],
+  };
+  NSData* json = [NSJSONSerialization dataWithJSONObject:fixture options:NSJSONWritingPrettyPrinted error:nil];
+  BOOL success = [json writeToFile:[directory stringByAppendingPathComponent:@"fixture.json"] atomically:YES];
+  assert(success);
+  return fixture;
+}
+
+// Records the scenario once if needed, then replays it. setUp runs before each iteration, from the beginning of the
+// recording, and is not measured.
+static void runScenario(TKRScenarioRunner* runner,
+                        NSDictionary* fixture,
+                        BOOL record,
+                        NSString* name,
+                        NSDictionary<NSString*, id>* parameters,
+                        NSUInteger iterations,
+                        TKRScenarioSetUp setUp,
+                        TKRScenarioBlock block)
+{
+  NSString* recordingPath = [[fixture[@"directory"] stringByAppendingPathComponent:@"recordings"]
+      stringByAppendingPathComponent:[name stringByAppendingPathExtension:@"json"]];
+
+  if (record)
+  {
+    TKRReplayBackend* recorder = [TKRReplayBackend recordingBackend];
+    TKRTanker* tanker = setUp(recorder);
+    block(tanker);
+    stopTanker(tanker);
+    NSError* err = nil;
+    BOOL success = [recorder saveRecordingTo:recordingPath error:&err];
+    assert(success);
+  }
+
+  NSError* err = nil;
+  TKRReplayBackend* backend = [TKRReplayBackend backendWithRecording:recordingPath error:&err];
+  assert(backend);
+
+  __block TKRTanker* tanker = nil;
+  [runner run:name
+      parameters:parameters
+      iterations:iterations
+           setUp:^{
+             if (tanker)
+               stopTanker(tanker);
+             [backend rewind];
+             tanker = setUp(backend);
+           }
+           block:^{
+             block(tanker);
+           }];
+  stopTanker(tanker);
+}
+
+SpecBegin(TankerOfflineBenchmarks)
+    NSString* const fixturesDirectory = [[NSProcessInfo processInfo] environment][@"TANKER_BENCHMARKS_FIXTURES"];
+    void (*const describeBenchmarks)(NSString*, void (^)(void)) = fixturesDirectory ? describe : xdescribe;
+
+    describeBenchmarks(@"Tanker offline benchmarks", ^{
+      __block TKRTestAdmin* admin;
+      __block NSString* appID;
+      __block NSDictionary* fixture;
+      __block BOOL record;
+      __block NSUInteger maxSize;
+      __block TKRScenarioRunner* runner;
+
+      beforeAll(^{
+        NSDictionary* env = [[NSProcessInfo processInfo] environment];
+        NSString* directory = fixturesDirectory;
+        record = [env[@"TANKER_BENCHMARKS_RECORD"] isEqualToString:@"1"];
+        maxSize = env[@"TANKER_BENCHMARKS_MAX_SIZE"] ? (NSUInteger)[env[@"TANKER_BENCHMARKS_MAX_SIZE"] longLongValue]
+                                                     : NSUIntegerMax;
+        NSString* resultsPath =
+            env[@"TANKER_BENCHMARKS_RESULTS"]
+                ?: [NSTemporaryDirectory() stringByAppendingPathComponent:@"tanker-benchmarks.json"];
+        runner = [TKRScenarioRunner runnerWithResultsPath:resultsPath];
+
+        if (record)
+        {
+          NSString* appManagementToken = env[@"TANKER_MANAGEMENT_API_ACCESS_TOKEN"];
+          expect(appManagementToken).toNot.beNil();
+          NSString* appManagementUrl = env[@"TANKER_MANAGEMENT_API_URL"];
+          expect(appManagementUrl).toNot.beNil();
+          NSString* environmentName = env[@"TANKER_MANAGEMENT_API_DEFAULT_ENVIRONMENT_NAME"];
+          expect(environmentName).toNot.beNil();
+          NSString* url = env[@"TANKER_APPD_URL"];
+          expect(url).toNot.beNil();
+
+          admin = [TKRTestAdmin adminWithUrl:appManagementUrl
+                          appManagementToken:appManagementToken
+                             environmentName:environmentName];
+          NSDictionary* appDescriptor = [admin createAppWithName:@"sdk-ios-offline-benchmarks"][@"app"];
+          appID = appDescriptor[@"id"];
+          createFixtures(directory, url, appID, appDescriptor[@"secret"]);
+        }
+
+        NSData* json = [NSData dataWithContentsOfFile:[directory stringByAppendingPathComponent:@"fixture.json"]];
+        expect(json).toNot.beNil();
+        NSMutableDictionary* loaded = [NSJSONSerialization JSONObjectWithData:json
+                                                                      options:NSJSONReadingMutableContainers
+                                                                        error:nil];
+        expect(loaded).toNot.beNil();
+        loaded[@"directory"] = directory;
+        fixture = loaded;
+      });
+
+      afterAll(^{
+        NSError* err = nil;
+        expect([runner writeResults:&err]).to.beTruthy();
+        expect(err).to.beNil();
+        if (admin)
+          [admin deleteApp:appID];
+      });
+
+      it(@"starts", ^{
+        for (NSNumber* withCache in @[ @YES, @NO ])
+        {
+          NSString* name = withCache.boolValue ? @"start.hot" : @"start.cold";
+          runScenario(
+              runner,
+              fixture,
+              record,
+              name,
+              @{@"cache" : withCache},
+              20,
+              ^(id<TKRHTTPTransport> transport) {
+                TKRTanker* tanker = [TKRTanker tankerWithOptions:fixtureOptions(fixture, withCache.boolValue, transport)
+                                                           error:nil];
+                assert(tanker);
+                return tanker;
+              },
+              ^(TKRTanker* tanker) {
+                startTanker(tanker, fixture[@"identity"]);
+              });
+        }
+      });
+
+      describe(@"payload sizes", ^{
+        NSArray<NSArray*>* const sizes = @[
+          @[ @"1B", @1, @20 ],
+          @[ @"1KB", @1024, @20 ],
+          @[ @"1MB", @(1024 * 1024), @20 ],
+          @[ @"100MB", @(100 * 1024 * 1024), @5 ],
+          @[ @"1GB", @(1024 * 1024 * 1024), @2 ],
+        ];
+
+        it(@"encrypts and decrypts data", ^{
+          for (NSArray* size in sizes)
+          {
+            NSUInteger const byteCount = [size[1] unsignedIntegerValue];
+            if (byteCount > maxSize)
+              continue;
+            NSUInteger const iterations = [size[2] unsignedIntegerValue];
+            __block NSData* payload = createPayload(byteCount);
+            __block NSData* encrypted = nil;
+
+            runScenario(
+                runner,
+                fixture,
+                record,
+                [@"encryptData." stringByAppendingString:size[0]],
+                @{@"size" : size[1]},
+                iterations,
+                ^(id<TKRHTTPTransport> transport) {
+                  return startFixtureTanker(fixture, YES, transport);
+                },
+                ^(TKRTanker* tanker) {
+                  encryptData(tanker, payload);
+                });
+            runScenario(
+                runner,
+                fixture,
+                record,
+                [@"decryptData." stringByAppendingString:size[0]],
+                @{@"size" : size[1]},
+                iterations,
+                ^(id<TKRHTTPTransport> transport) {
+                  TKRTanker* tanker = startFixtureTanker(fixture, YES, transport);
+                  encrypted = encryptData(tanker, payload);
+                  return tanker;
+                },
+                ^(TKRTanker* tanker) {
+                  decryptData(tanker, encrypted);
+                });
+            payload = nil;
+            encrypted = nil;
+          }
+        });
+
+        it(@"encrypts and decrypts streams", ^{
+          for (NSArray* size in sizes)
+          {
+            NSUInteger const byteCount = [size[1] unsignedIntegerValue];
+            if (byteCount > maxSize)
+              continue;
+            NSUInteger const iterations = [size[2] unsignedIntegerValue];
+            __block NSData* payload = createPayload(byteCount);
+            __block NSData* encrypted = nil;
+
+            runScenario(
+                runner,
+                fixture,
+                record,
+                [@"encryptStream." stringByAppendingString:size[0]],
+                @{@"size" : size[1]},
+                iterations,
+                ^(id<TKRHTTPTransport> transport) {
+                  return startFixtureTanker(fixture, YES, transport);
+                },
+                ^(TKRTanker* tanker) {
+                  NSInputStream* encryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
+                    [tanker encryptStream:[NSInputStream inputStreamWithData:payload] completionHandler:adapter];
+                  });
+                  readStream(encryptedStream);
+                });
+            runScenario(
+                runner,
+                fixture,
+                record,
+                [@"decryptStream." stringByAppendingString:size[0]],
+                @{@"size" : size[1]},
+                iterations,
+                ^(id<TKRHTTPTransport> transport) {
+                  TKRTanker* tanker = startFixtureTanker(fixture, YES, transport);
+                  NSInputStream* encryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
+                    [tanker encryptStream:[NSInputStream inputStreamWithData:payload] completionHandler:adapter];
+                  });
+                  encrypted = readStream(encryptedStream);
+                  return tanker;
+                },
+                ^(TKRTanker* tanker) {
+                  NSInputStream* decryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
+                    [tanker decryptStream:[NSInputStream inputStreamWithData:encrypted] completionHandler:adapter];
+                  });
+                  readStream(decryptedStream);
+                });
+            payload = nil;
+            encrypted = nil;
+          }
+        });
+      });
+
+      it(@"shares", ^{
+        __block NSString* resourceID = nil;
+        runScenario(
+            runner,
+            fixture,
+            record,
+            @"share",
+            @{@"recipients" : @1},
+            20,
+            ^(id<TKRHTTPTransport> transport) {
+              TKRTanker* tanker = startFixtureTanker(fixture, YES, transport);
+              resourceID = [tanker resourceIDOfEncryptedData:encryptData(tanker, createPayload(1024)) error:nil];
+              assert(resourceID);
+              return tanker;
+            },
+            ^(TKRTanker* tanker) {
+              TKRSharingOptions* options = [[TKRSharingOptions alloc] init];
+              options.shareWithUsers = @[ fixture[@"bobPublicIdentity"] ];
+              NSError* err = hangWithResolver(^(PMKResolver resolve) {
+                [tanker shareResourceIDs:@[ resourceID ] options:options completionHandler:resolve];
+              });
+              assert(!err);
+            });
+      });
+
+      it(@"creates and updates groups", ^{
+        runScenario(
+            runner,
+            fixture,
+            record,
+            @"createGroup",
+            @{@"members" : @2},
+            20,
+            ^(id<TKRHTTPTransport> transport) {
+              return startFixtureTanker(fixture, YES, transport);
+            },
+            ^(TKRTanker* tanker) {
+              id groupID = hangWithAdapter(^(PMKAdapter adapter) {
+                [tanker createGroupWithIdentities:@[ fixture[@"publicIdentity"], fixture[@"bobPublicIdentity"] ]
+                                completionHandler:adapter];
+              });
+              assert([groupID isKindOfClass:[NSString class]]);
+            });
+        runScenario(
+            runner,
+            fixture,
+            record,
+            @"updateMembers",
+            @{@"usersToAdd" : @1},
+            20,
+            ^(id<TKRHTTPTransport> transport) {
+              return startFixtureTanker(fixture, YES, transport);
+            },
+            ^(TKRTanker* tanker) {
+              NSError* err = hangWithResolver(^(PMKResolver resolve) {
+                [tanker updateMembersOfGroup:fixture[@"groupID"]
+                                  usersToAdd:@[ fixture[@"carolPublicIdentity"] ]
+                           completionHandler:resolve];
+              });
+              assert(!err);
+            });
+      });
+
+      it(@"decrypts with a cold and a hot key cache", ^{
+        NSData* encrypted = [[NSData alloc] initWithBase64EncodedString:fixture[@"encrypted"] options:0];
+        for (NSNumber* hot in @[ @NO, @YES ])
+        {
+          runScenario(
+              runner,
+              fixture,
+              record,
+              hot.boolValue ? @"decryptFixture.hot" : @"decryptFixture.cold",
+              @{@"keyCached" : hot},
+              20,
+              ^(id<TKRHTTPTransport> transport) {
+                TKRTanker* tanker = startFixtureTanker(fixture, YES, transport);
+                if (hot.boolValue)
+                  decryptData(tanker, encrypted);
+                return tanker;
+              },
+              ^(TKRTanker* tanker) {
+                decryptData(tanker, encrypted);
+              });
+        }
+      });
+    });
+SpecEnd
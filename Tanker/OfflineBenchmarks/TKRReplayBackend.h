@@ -0,0 +1,50 @@
+#import <Foundation/Foundation.h>
+
+#import <Tanker/TKRHTTPTransport+Private.h>
+
+/*!
+ @brief Stand-in for the Tanker servers, plugged in as the HTTP transport of a TKRTanker
+
+ @discussion A recording backend forwards the requests to the real servers and records each exchange. A replaying
+ backend answers from such a recording, without network access.
+
+ Requests are matched by method, path (without the query) and occurrence: the third "GET /x" gets the response of the
+ third recorded "GET /x". Once the recorded occurrences are exhausted, the last one is repeated, so that a scenario
+ recorded once can be replayed for any number of iterations. Requests that were never recorded fail.
+ */
+@interface TKRReplayBackend : NSObject <TKRHTTPTransport>
+
+// MARK: Class methods
+
++ (nonnull instancetype)recordingBackend;
+
+/*!
+ @brief Create a backend replaying a recording made by saveRecordingTo:error:.
+ */
++ (nullable instancetype)backendWithRecording:(nonnull NSString*)path error:(NSError* _Nullable* _Nullable)error;
+
+// MARK: Instance methods
+
+/*!
+ @brief Save the exchanges recorded so far, as JSON.
+ */
+- (BOOL)saveRecordingTo:(nonnull NSString*)path error:(NSError* _Nullable* _Nullable)error;
+
+/*!
+ @brief Restart the occurrence count of each request, e.g. before replaying a scenario again.
+ */
+- (void)rewind;
+
+// MARK: Properties
+
+/*!
+ @brief Delay added before each replayed response, to simulate a network round trip. 0 by default.
+ */
+@property NSTimeInterval latency;
+
+/*!
+ @brief Number of requests sent to this backend.
+ */
+@property(readonly) NSUInteger requestCount;
+
+@end
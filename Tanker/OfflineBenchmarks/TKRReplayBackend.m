@@ -0,0 +1,164 @@
+#import "TKRReplayBackend.h"
+
+@interface TKRReplayBackend ()
+
+@property(readwrite) NSUInteger requestCount;
+
+// nil when replaying
+@property(nullable) NSURLSession* session;
+// guarded by self
+@property(nonnull) NSMutableArray<NSDictionary*>* recorded;
+@property(nonnull) NSDictionary<NSString*, NSArray<NSDictionary*>*>* exchangesByRequest;
+@property(nonnull) NSMutableDictionary<NSString*, NSNumber*>* occurrences;
+
+@end
+
+static NSString* requestKey(NSURLRequest* request)
+{
+  return [NSString stringWithFormat:@"%@ %@", request.HTTPMethod ?: @"GET", request.URL.path];
+}
+
+static NSError* replayError(NSString* message)
+{
+  return [NSError errorWithDomain:@"TKRReplayBackend" code:1 userInfo:@{NSLocalizedDescriptionKey : message}];
+}
+
+@implementation TKRReplayBackend
+
+// MARK: Class methods
+
++ (nonnull instancetype)recordingBackend
+{
+  TKRReplayBackend* ret = [[self alloc] init];
+  ret.session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration ephemeralSessionConfiguration]];
+  ret.recorded = [NSMutableArray array];
+  ret.exchangesByRequest = @{};
+  ret.occurrences = [NSMutableDictionary dictionary];
+  return ret;
+}
+
++ (nullable instancetype)backendWithRecording:(nonnull NSString*)path error:(NSError* _Nullable* _Nullable)error
+{
+  NSData* json = [NSData dataWithContentsOfFile:path options:0 error:error];
+  if (!json)
+    return nil;
+  NSDictionary* recording = [NSJSONSerialization JSONObjectWithData:json options:0 error:error];
+  if (!recording)
+    return nil;
+
+  NSMutableDictionary<NSString*, NSMutableArray<NSDictionary*>*>* exchangesByRequest = [NSMutableDictionary dictionary];
+  for (NSDictionary* exchange in recording[@"exchanges"])
+  {
+    NSString* key = exchange[@"request"];
+    if (!exchangesByRequest[key])
+      exchangesByRequest[key] = [NSMutableArray array];
+    [exchangesByRequest[key] addObject:exchange];
+  }
+
+  TKRReplayBackend* ret = [[self alloc] init];
+  ret.recorded = [NSMutableArray array];
+  ret.exchangesByRequest = exchangesByRequest;
+  ret.occurrences = [NSMutableDictionary dictionary];
+  return ret;
+}
+
+// MARK: Instance methods
+
+- (BOOL)saveRecordingTo:(nonnull NSString*)path error:(NSError* _Nullable* _Nullable)error
+{
+  NSData* json;
+  @synchronized(self)
+  {
+    json = [NSJSONSerialization dataWithJSONObject:@{@"exchanges" : self.recorded}
+                                           options:NSJSONWritingPrettyPrinted
+                                             error:error];
+  }
+  return json && [json writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+- (void)rewind
+{
+  @synchronized(self)
+  {
+    [self.occurrences removeAllObjects];
+  }
+}
+
+- (void)sendRequest:(nonnull NSURLRequest*)request completionHandler:(nonnull TKRHTTPResponseHandler)handler
+{
+  NSString* key = requestKey(request);
+  @synchronized(self)
+  {
+    self.requestCount++;
+  }
+
+  if (self.session)
+    [self recordRequest:request key:key completionHandler:handler];
+  else
+    [self replayRequest:request key:key completionHandler:handler];
+}
+
+- (void)recordRequest:(nonnull NSURLRequest*)request
+                  key:(nonnull NSString*)key
+    completionHandler:(nonnull TKRHTTPResponseHandler)handler
+{
+  NSURLSessionDataTask* task = [self.session
+      dataTaskWithRequest:request
+        completionHandler:^(NSData* data, NSURLResponse* baseResponse, NSError* error) {
+          NSHTTPURLResponse* response = (NSHTTPURLResponse*)baseResponse;
+          NSDictionary* exchange;
+          if (error)
+            exchange = @{@"request" : key, @"error" : error.localizedDescription};
+          else
+            exchange = @{
+              @"request" : key,
+              @"status" : @(response.statusCode),
+              @"headers" : response.allHeaderFields,
+              @"body" : [(data ?: [NSData data]) base64EncodedStringWithOptions:0],
+            };
+          @synchronized(self)
+          {
+            [self.recorded addObject:exchange];
+          }
+          handler(data, baseResponse, error);
+        }];
+  [task resume];
+}
+
+- (void)replayRequest:(nonnull NSURLRequest*)request
+                  key:(nonnull NSString*)key
+    completionHandler:(nonnull TKRHTTPResponseHandler)handler
+{
+  NSArray<NSDictionary*>* exchanges = self.exchangesByRequest[key];
+  NSDictionary* exchange;
+  @synchronized(self)
+  {
+    NSUInteger const occurrence = self.occurrences[key].unsignedIntegerValue;
+    self.occurrences[key] = @(occurrence + 1);
+    exchange = exchanges.count ? exchanges[MIN(occurrence, exchanges.count - 1)] : nil;
+  }
+
+  NSData* body = nil;
+  NSHTTPURLResponse* response = nil;
+  NSError* error = nil;
+  if (!exchange)
+    error = replayError([NSString stringWithFormat:@"no recorded response for %@", key]);
+  else if (exchange[@"error"])
+    error = replayError(exchange[@"error"]);
+  else
+  {
+    body = [[NSData alloc] initWithBase64EncodedString:exchange[@"body"] options:0];
+    response = [[NSHTTPURLResponse alloc] initWithURL:request.URL
+                                           statusCode:[exchange[@"status"] integerValue]
+                                          HTTPVersion:@"HTTP/1.1"
+                                         headerFields:exchange[@"headers"]];
+  }
+
+  // never answer from within the native send callback
+  dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.latency * NSEC_PER_SEC)), queue, ^{
+    handler(body, response, error);
+  });
+}
+
+@end
@@ -0,0 +1,37 @@
+#import <Foundation/Foundation.h>
+
+/*!
+ @brief Runs benchmark scenarios and collects their results as JSON, for regression tracking
+
+ @discussion The results file contains the SDK and native versions, the date, and for each scenario its parameters,
+ number of iterations and the mean, min, median, 90th percentile and max durations, in seconds.
+ */
+@interface TKRScenarioRunner : NSObject
+
+// MARK: Class methods
+
++ (nonnull instancetype)runnerWithResultsPath:(nonnull NSString*)path;
+
+// MARK: Instance methods
+
+/*!
+ @brief Run a scenario several times.
+
+ @param name the name under which the result is reported.
+ @param parameters values describing the scenario, e.g. the payload size, written along the result.
+ @param iterations the number of measured runs, after one warm-up run.
+ @param setUp called before each run, not measured.
+ @param block the measured block, it must only return once the measured work is done.
+ */
+- (void)run:(nonnull NSString*)name
+    parameters:(nonnull NSDictionary<NSString*, id>*)parameters
+    iterations:(NSUInteger)iterations
+         setUp:(nullable void (^)(void))setUp
+         block:(nonnull void (^)(void))block;
+
+/*!
+ @brief Write the results of the scenarios run so far to the results path.
+ */
+- (BOOL)writeResults:(NSError* _Nullable* _Nullable)error;
+
+@end
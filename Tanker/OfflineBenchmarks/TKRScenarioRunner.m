@@ -0,0 +1,93 @@
+#import "TKRScenarioRunner.h"
+#import "TKRBenchmark.h"
+
+#import <Tanker/TKRTanker.h>
+
+#include <time.h>
+
+@interface TKRScenarioRunner ()
+
+@property(nonnull) NSString* resultsPath;
+@property(nonnull) NSMutableArray<NSDictionary*>* results;
+
+@end
+
+static NSTimeInterval percentile(NSArray<NSNumber*>* sorted, double fraction)
+{
+  NSUInteger const index = (NSUInteger)ceil(fraction * sorted.count);
+  return sorted[MIN(MAX(index, 1), sorted.count) - 1].doubleValue;
+}
+
+@implementation TKRScenarioRunner
+
+// MARK: Class methods
+
++ (nonnull instancetype)runnerWithResultsPath:(nonnull NSString*)path
+{
+  TKRScenarioRunner* ret = [[self alloc] init];
+  ret.resultsPath = path;
+  ret.results = [NSMutableArray array];
+  return ret;
+}
+
+// MARK: Instance methods
+
+- (void)run:(nonnull NSString*)name
+    parameters:(nonnull NSDictionary<NSString*, id>*)parameters
+    iterations:(NSUInteger)iterations
+         setUp:(nullable void (^)(void))setUp
+         block:(nonnull void (^)(void))block
+{
+  NSMutableArray<NSNumber*>* durations = [NSMutableArray arrayWithCapacity:iterations];
+  NSTimeInterval total = 0;
+  // the first run warms up caches and lazy initializations
+  for (NSUInteger i = 0; i < iterations + 1; ++i)
+  {
+    if (setUp)
+      setUp();
+    uint64_t const start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    block();
+    NSTimeInterval const duration =
+        (NSTimeInterval)(clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start) / NSEC_PER_SEC;
+    if (i == 0)
+      continue;
+    [durations addObject:@(duration)];
+    total += duration;
+  }
+  if (!iterations)
+    return;
+
+  NSArray<NSNumber*>* sorted = [durations sortedArrayUsingSelector:@selector(compare:)];
+  NSTimeInterval const mean = total / iterations;
+  [TKRBenchmark report:name duration:mean];
+  [self.results addObject:@{
+    @"name" : name,
+    @"parameters" : parameters,
+    @"iterations" : @(iterations),
+    @"mean" : @(mean),
+    @"min" : sorted.firstObject,
+    @"median" : @(percentile(sorted, 0.5)),
+    @"p90" : @(percentile(sorted, 0.9)),
+    @"max" : sorted.lastObject,
+  }];
+}
+
+- (BOOL)writeResults:(NSError* _Nullable* _Nullable)error
+{
+  NSISO8601DateFormatter* formatter = [[NSISO8601DateFormatter alloc] init];
+  NSDictionary* report = @{
+    @"sdkVersion" : [TKRTanker versionString],
+    @"nativeVersion" : [TKRTanker nativeVersionString],
+    @"date" : [formatter stringFromDate:[NSDate date]],
+    @"scenarios" : self.results,
+  };
+  NSData* json = [NSJSONSerialization dataWithJSONObject:report
+                                                 options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys
+                                                   error:error];
+  if (!json || ![json writeToFile:self.resultsPath options:NSDataWritingAtomic error:error])
+    return NO;
+  NSLog(@"[benchmark] results written to %@", self.resultsPath);
+  return YES;
+}
+
+@end
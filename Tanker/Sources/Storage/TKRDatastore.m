@@ -6,6 +6,7 @@
 
 #import <sqlite3.h>
 
+#include <stdatomic.h>
 #import <stdlib.h>
 
 static int const latestCacheVersion = 1;
@@ -14,13 +15,33 @@ static int const latestDeviceVersion = 1;
 NSString* const cacheTableName = @"cache";
 NSString* const deviceTableName = @"device";
 
+// staged values are flushed right away past this count, whatever the delay
+static NSUInteger const maxStagedCacheValues = 1000;
+
 @interface TKRDatastore ()
+{
+  atomic_ulong _cacheCommitCount;
+}
 
 @property sqlite3* persistent_handle;
 @property sqlite3* cache_handle;
 
+// Write-behind state, guarded by @synchronized(self).
+// A key is staged in at most one of them: replaced values win over the stored ones, ignored values do not.
+@property(nonnull) NSMutableDictionary<NSData*, NSData*>* stagedReplacedValues;
+@property(nonnull) NSMutableDictionary<NSData*, NSData*>* stagedIgnoredValues;
+@property BOOL flushScheduled;
+@property(nonnull) dispatch_queue_t flushQueue;
+
 @end
 
+static int countCommit(void* counter)
+{
+  atomic_fetch_add_explicit((atomic_ulong*)counter, 1, memory_order_relaxed);
+  // non-zero would turn the commit into a rollback
+  return 0;
+}
+
 static TKRDatastoreError translateSQLiteError(int err_code)
 {
   assert(err_code != SQLITE_OK && err_code != SQLITE_ROW && err_code != SQLITE_DONE);
@@ -267,10 +288,10 @@ static NSArray<NSArray<NSData*>*>* _Nullable retrieveCachedValues(sqlite3* handl
   case 0:
     if ((err = [self createDeviceTable]))
       return err;
-    if ((err = setDbVersion(self.persistent_handle, latestCacheVersion)))
+    if ((err = setDbVersion(self.persistent_handle, latestDeviceVersion)))
       return err;
     // fallthrough
-  case latestCacheVersion:
+  case latestDeviceVersion:
     return nil;
   default:
   {
@@ -328,6 +349,12 @@ static NSArray<NSArray<NSData*>*>* _Nullable retrieveCachedValues(sqlite3* handl
 {
   if (self = [super init])
   {
+    _writeBehindDelay = 0;
+    atomic_init(&_cacheCommitCount, 0);
+    self.stagedReplacedValues = [NSMutableDictionary dictionary];
+    self.stagedIgnoredValues = [NSMutableDictionary dictionary];
+    self.flushQueue = dispatch_queue_create("io.tanker.datastore.flush", DISPATCH_QUEUE_SERIAL);
+
     sqlite3* tmp;
     if ((*err = openOrCreateDb([persistentPath stringByAppendingString:@"-device.db"], &tmp)))
       goto fail;
@@ -335,6 +362,7 @@ static NSArray<NSArray<NSData*>*>* _Nullable retrieveCachedValues(sqlite3* handl
     if ((*err = openOrCreateDb([cachePath stringByAppendingString:@"-cache.db"], &tmp)))
       goto fail;
     self.cache_handle = tmp;
+    sqlite3_commit_hook(tmp, countCommit, &_cacheCommitCount);
     if ((*err = [self migrate]))
       goto fail;
   }
@@ -351,6 +379,12 @@ fail:
   NSString* format = @"DELETE FROM %@";
   NSError* err;
 
+  @synchronized(self)
+  {
+    [self.stagedReplacedValues removeAllObjects];
+    [self.stagedIgnoredValues removeAllObjects];
+  }
+
   sqlite3_exec(
       self.persistent_handle, [NSString stringWithFormat:format, deviceTableName].UTF8String, NULL, NULL, NULL);
   if ((err = errorFromSQLite(self.persistent_handle)))
@@ -360,6 +394,17 @@ fail:
 }
 
 - (void)close
+{
+  @synchronized(self)
+  {
+    NSError* flushErr = [self flushCacheValues];
+    if (flushErr)
+      NSLog(@"Could not flush cache storage: %@", flushErr.localizedDescription);
+    [self closeHandles];
+  }
+}
+
+- (void)closeHandles
 {
   if (sqlite3_close(self.persistent_handle) != SQLITE_OK)
   {
@@ -376,14 +421,162 @@ fail:
   self.cache_handle = nil;
 }
 
+- (NSUInteger)cacheCommitCount
+{
+  return atomic_load_explicit(&_cacheCommitCount, memory_order_relaxed);
+}
+
+- (void)setWriteBehindDelay:(NSTimeInterval)writeBehindDelay
+{
+  @synchronized(self)
+  {
+    _writeBehindDelay = writeBehindDelay;
+    if (writeBehindDelay > 0)
+      return;
+    NSError* err = [self flushCacheValues];
+    if (err)
+      NSLog(@"Could not flush cache storage: %@", err.localizedDescription);
+  }
+}
+
+- (BOOL)hasStagedCacheValues
+{
+  return self.stagedReplacedValues.count + self.stagedIgnoredValues.count > 0;
+}
+
+- (nullable NSError*)writeCacheValues:(nonnull NSDictionary<NSData*, NSData*>*)keyValues
+                           onConflict:(TKRDatastoreOnConflict)action
+{
+  NSString* query = buildCacheRequest(cacheTableName, keyValues, action);
+  sqlite3_exec(self.cache_handle, query.UTF8String, NULL, NULL, NULL);
+  return errorFromSQLite(self.cache_handle);
+}
+
+- (nullable NSArray<id>*)findStoredCacheValuesWithKeys:(nonnull NSArray<NSData*>*)keys
+                                                 error:(NSError* _Nullable* _Nonnull)err
+{
+  NSString* query = buildFindCacheRequest(keys);
+  NSArray<NSArray<NSData*>*>* values = retrieveCachedValues(self.cache_handle, query, err);
+
+  if (*err)
+    return nil;
+  return setDifferenceToNull(keys, values);
+}
+
+// Staged values must fail like INSERT OR FAIL would have, before anything is staged
+- (nullable NSError*)checkCacheKeysAreFree:(nonnull NSArray<NSData*>*)keys
+{
+  NSError* err = nil;
+  NSArray<id>* stored = [self findStoredCacheValuesWithKeys:keys error:&err];
+  if (err)
+    return err;
+
+  for (NSUInteger i = 0; i < keys.count; ++i)
+  {
+    if (stored[i] != [NSNull null] || self.stagedReplacedValues[keys[i]] || self.stagedIgnoredValues[keys[i]])
+      return TKR_createNSErrorWithDomain(
+          TKRDatastoreErrorDomain, TKRDatastoreErrorConstraintFailed, @"UNIQUE constraint failed: cache.key");
+  }
+  return nil;
+}
+
+- (void)scheduleFlush
+{
+  if (self.stagedReplacedValues.count + self.stagedIgnoredValues.count >= maxStagedCacheValues)
+  {
+    dispatch_async(self.flushQueue, ^{
+      [self flushScheduledCacheValues];
+    });
+    return;
+  }
+  if (self.flushScheduled)
+    return;
+  self.flushScheduled = YES;
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.writeBehindDelay * NSEC_PER_SEC)),
+                 self.flushQueue,
+                 ^{
+                   [self flushScheduledCacheValues];
+                 });
+}
+
+- (void)flushScheduledCacheValues
+{
+  // the cache can be re-fetched, losing a batch is not fatal
+  NSError* err = [self flushCacheValues];
+  if (err)
+    NSLog(@"Could not flush cache storage: %@", err.localizedDescription);
+}
+
+- (nullable NSError*)flushCacheValues
+{
+  @synchronized(self)
+  {
+    self.flushScheduled = NO;
+    if (![self hasStagedCacheValues] || !self.cache_handle)
+      return nil;
+
+    NSError* err = nil;
+    sqlite3_exec(self.cache_handle, "BEGIN", NULL, NULL, NULL);
+    if ((err = errorFromSQLite(self.cache_handle)))
+      goto clear;
+    if (self.stagedReplacedValues.count &&
+        (err = [self writeCacheValues:self.stagedReplacedValues onConflict:TKRDatastoreOnConflictReplace]))
+      goto rollback;
+    if (self.stagedIgnoredValues.count &&
+        (err = [self writeCacheValues:self.stagedIgnoredValues onConflict:TKRDatastoreOnConflictIgnore]))
+      goto rollback;
+    sqlite3_exec(self.cache_handle, "COMMIT", NULL, NULL, NULL);
+    if ((err = errorFromSQLite(self.cache_handle)))
+      goto rollback;
+    goto clear;
+
+  rollback:
+    sqlite3_exec(self.cache_handle, "ROLLBACK", NULL, NULL, NULL);
+  clear:
+    [self.stagedReplacedValues removeAllObjects];
+    [self.stagedIgnoredValues removeAllObjects];
+    return err;
+  }
+}
+
 - (nullable NSError*)cacheValues:(nonnull NSDictionary<NSData*, NSData*>*)keyValues
                       onConflict:(TKRDatastoreOnConflict)action
 {
   if (keyValues.count == 0)
     return nil;
-  NSString* query = buildCacheRequest(cacheTableName, keyValues, action);
-  sqlite3_exec(self.cache_handle, query.UTF8String, NULL, NULL, NULL);
-  return errorFromSQLite(self.cache_handle);
+
+  @synchronized(self)
+  {
+    if (self.writeBehindDelay <= 0)
+      return [self writeCacheValues:keyValues onConflict:action];
+
+    if (action == TKRDatastoreOnConflictFail)
+    {
+      NSError* err = [self checkCacheKeysAreFree:keyValues.allKeys];
+      if (err)
+        return err;
+    }
+    for (NSData* key in keyValues)
+    {
+      // the bindings hand out data pointing into native buffers, which do not outlive the call
+      NSData* ownedKey = [NSData dataWithBytes:key.bytes length:key.length];
+      NSData* value = keyValues[key];
+      NSData* ownedValue = [NSData dataWithBytes:value.bytes length:value.length];
+
+      if (action == TKRDatastoreOnConflictIgnore)
+      {
+        if (!self.stagedReplacedValues[ownedKey] && !self.stagedIgnoredValues[ownedKey])
+          self.stagedIgnoredValues[ownedKey] = ownedValue;
+      }
+      else
+      {
+        [self.stagedIgnoredValues removeObjectForKey:ownedKey];
+        self.stagedReplacedValues[ownedKey] = ownedValue;
+      }
+    }
+    [self scheduleFlush];
+    return nil;
+  }
 }
 
 - (nullable NSArray<id>*)findCacheValuesWithKeys:(nonnull NSArray<NSData*>*)keys error:(NSError* _Nullable* _Nonnull)err
@@ -392,12 +585,24 @@ fail:
   if (keys.count == 0)
     return @[];
 
-  NSString* query = buildFindCacheRequest(keys);
-  NSArray<NSArray<NSData*>*>* values = retrieveCachedValues(self.cache_handle, query, err);
+  @synchronized(self)
+  {
+    NSArray<id>* values = [self findStoredCacheValuesWithKeys:keys error:err];
+    if (!values || ![self hasStagedCacheValues])
+      return values;
 
-  if (*err)
-    return nil;
-  return setDifferenceToNull(keys, values);
+    NSMutableArray<id>* merged = [values mutableCopy];
+    for (NSUInteger i = 0; i < keys.count; ++i)
+    {
+      NSData* replaced = self.stagedReplacedValues[keys[i]];
+      NSData* ignored = self.stagedIgnoredValues[keys[i]];
+      if (replaced)
+        merged[i] = replaced;
+      else if (ignored && merged[i] == [NSNull null])
+        merged[i] = ignored;
+    }
+    return merged;
+  }
 }
 
 - (nullable NSError*)setSerializedDevice:(nonnull NSData*)serializedDevice
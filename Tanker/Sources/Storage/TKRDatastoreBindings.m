@@ -1,6 +1,7 @@
 #import <Tanker/Storage/TKRDatastoreBindings.h>
 
 #import <Tanker/Storage/TKRDatastore.h>
+#import <Tanker/TKRTracer+Private.h>
 
 #import <Tanker/ctanker/datastore.h>
 
@@ -9,26 +10,108 @@ static void report_error(void* error_handle, NSError* _Nonnull err)
   tanker_datastore_report_error(error_handle, err.code, err.localizedDescription.UTF8String);
 }
 
-void TKR_datastore_open(void* error_handle, void** datastore, char const* data_path, char const* cache_path)
+// Settings of the datastores opened under a cache directory, shared by the TKRTanker instances created with it
+@interface TKRDatastoreSettings : NSObject
+
+@property double writeBehindDelay;
+@property NSUInteger instanceCount;
+
+@end
+
+@implementation TKRDatastoreSettings
+@end
+
+// The open callback only receives paths, so the datastore settings are looked up from the cache directory
+// the TKRTanker was created with, which the native cache path lives in.
+static NSMutableDictionary<NSString*, TKRDatastoreSettings*>* datastoreSettings(void)
+{
+  static NSMutableDictionary<NSString*, TKRDatastoreSettings*>* settings;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    settings = [NSMutableDictionary dictionary];
+  });
+  return settings;
+}
+
+static TKRDatastoreSettings* _Nullable settingsForCachePath(NSString* _Nonnull cachePath)
+{
+  NSString* cacheDir = cachePath.stringByStandardizingPath.stringByDeletingLastPathComponent;
+  NSMutableDictionary<NSString*, TKRDatastoreSettings*>* settings = datastoreSettings();
+  @synchronized(settings)
+  {
+    return settings[cacheDir];
+  }
+}
+
+bool TKR_datastore_register_settings(char const* cache_dir, double write_behind_delay)
+{
+  if (!cache_dir)
+    return true;
+  NSString* cacheDir = [NSString stringWithUTF8String:cache_dir].stringByStandardizingPath;
+  double const delay = write_behind_delay > 0 ? write_behind_delay : 0;
+
+  NSMutableDictionary<NSString*, TKRDatastoreSettings*>* settings = datastoreSettings();
+  @synchronized(settings)
+  {
+    TKRDatastoreSettings* registered = settings[cacheDir];
+    if (!registered)
+    {
+      registered = [[TKRDatastoreSettings alloc] init];
+      registered.writeBehindDelay = delay;
+      settings[cacheDir] = registered;
+    }
+    else if (registered.writeBehindDelay != delay)
+      return false;
+    ++registered.instanceCount;
+  }
+  return true;
+}
+
+void TKR_datastore_unregister_settings(char const* cache_dir)
+{
+  if (!cache_dir)
+    return;
+  NSString* cacheDir = [NSString stringWithUTF8String:cache_dir].stringByStandardizingPath;
+
+  NSMutableDictionary<NSString*, TKRDatastoreSettings*>* settings = datastoreSettings();
+  @synchronized(settings)
+  {
+    TKRDatastoreSettings* registered = settings[cacheDir];
+    if (registered && --registered.instanceCount == 0)
+      [settings removeObjectForKey:cacheDir];
+  }
+}
+
+static void datastoreOpen(void* error_handle, void** datastore, char const* data_path, char const* cache_path)
 {
   NSString* persistentPath = [NSString stringWithUTF8String:data_path];
   NSString* cachePath = [NSString stringWithUTF8String:cache_path];
 
   NSError* err;
-
   TKRDatastore* store = [TKRDatastore datastoreWithPersistentPath:persistentPath cachePath:cachePath error:&err];
   if (err)
     return report_error(error_handle, err);
+  store.writeBehindDelay = settingsForCachePath(cachePath).writeBehindDelay;
   *datastore = (__bridge_retained void*)store;
 }
 
-void TKR_datastore_close(void* datastore)
+void TKR_datastore_open(void* error_handle, void** datastore, char const* data_path, char const* cache_path)
+{
+  TKR_TRACE_SPAN("datastore.open", datastoreOpen(error_handle, datastore, data_path, cache_path));
+}
+
+static void datastoreClose(void* datastore)
 {
   TKRDatastore* store = (__bridge_transfer TKRDatastore*)datastore;
   [store close];
 }
 
-void TKR_datastore_nuke(void* datastore, void* error_handle)
+void TKR_datastore_close(void* datastore)
+{
+  TKR_TRACE_SPAN("datastore.close", datastoreClose(datastore));
+}
+
+static void datastoreNuke(void* datastore, void* error_handle)
 {
   TKRDatastore* store = (__bridge TKRDatastore*)datastore;
   NSError* err = [store nuke];
@@ -36,7 +119,12 @@ void TKR_datastore_nuke(void* datastore, void* error_handle)
     report_error(error_handle, err);
 }
 
-void TKR_datastore_put_serialized_device(void* datastore,
+void TKR_datastore_nuke(void* datastore, void* error_handle)
+{
+  TKR_TRACE_SPAN("datastore.nuke", datastoreNuke(datastore, error_handle));
+}
+
+static void datastorePutSerializedDevice(void* datastore,
                                          void* error_handle,
                                          uint8_t const* serialized_device,
                                          uint32_t serialized_device_size)
@@ -51,7 +139,16 @@ void TKR_datastore_put_serialized_device(void* datastore,
     report_error(error_handle, err);
 }
 
-void TKR_datastore_find_serialized_device(void* datastore, void* result_handle)
+void TKR_datastore_put_serialized_device(void* datastore,
+                                         void* error_handle,
+                                         uint8_t const* serialized_device,
+                                         uint32_t serialized_device_size)
+{
+  TKR_TRACE_SPAN("datastore.put_serialized_device",
+                 datastorePutSerializedDevice(datastore, error_handle, serialized_device, serialized_device_size));
+}
+
+static void datastoreFindSerializedDevice(void* datastore, void* result_handle)
 {
   TKRDatastore* store = (__bridge TKRDatastore*)datastore;
   NSError* err;
@@ -66,7 +163,12 @@ void TKR_datastore_find_serialized_device(void* datastore, void* result_handle)
   memcpy(buffer, serializedDevice.bytes, serializedDevice.length);
 }
 
-void TKR_datastore_put_cache_values(void* datastore,
+void TKR_datastore_find_serialized_device(void* datastore, void* result_handle)
+{
+  TKR_TRACE_SPAN("datastore.find_serialized_device", datastoreFindSerializedDevice(datastore, result_handle));
+}
+
+static void datastorePutCacheValues(void* datastore,
                                     void* error_handle,
                                     uint8_t const* const* keys,
                                     uint32_t const* key_sizes,
@@ -91,7 +193,21 @@ void TKR_datastore_put_cache_values(void* datastore,
     report_error(error_handle, err);
 }
 
-void TKR_datastore_find_cache_values(
+void TKR_datastore_put_cache_values(void* datastore,
+                                    void* error_handle,
+                                    uint8_t const* const* keys,
+                                    uint32_t const* key_sizes,
+                                    uint8_t const* const* values,
+                                    uint32_t const* value_sizes,
+                                    uint32_t elem_count,
+                                    uint8_t on_conflict)
+{
+  TKR_TRACE_SPAN(
+      "datastore.put_cache_values",
+      datastorePutCacheValues(datastore, error_handle, keys, key_sizes, values, value_sizes, elem_count, on_conflict));
+}
+
+static void datastoreFindCacheValues(
     void* datastore, void* result_handle, uint8_t const* const* keys, uint32_t const* key_sizes, uint32_t elem_count)
 {
   TKRDatastore* store = (__bridge TKRDatastore*)datastore;
@@ -131,3 +247,10 @@ void TKR_datastore_find_cache_values(
   free(size_ptrs);
   free(out_ptrs);
 }
+
+void TKR_datastore_find_cache_values(
+    void* datastore, void* result_handle, uint8_t const* const* keys, uint32_t const* key_sizes, uint32_t elem_count)
+{
+  TKR_TRACE_SPAN("datastore.find_cache_values",
+                 datastoreFindCacheValues(datastore, result_handle, keys, key_sizes, elem_count));
+}
@@ -2,6 +2,8 @@
 #import <Tanker/TKRAsyncStreamReader+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
 
+#include <stdatomic.h>
+
 void readInput(uint8_t* _Nonnull out,
                int64_t n,
                tanker_stream_read_operation_t* _Nonnull op,
@@ -12,18 +14,26 @@ void readInput(uint8_t* _Nonnull out,
 
   // dispatch on main queue since streams are scheduled on it
   TKR_runOnMainQueue(^{
+    // the native stream still holds the reader, it is released once the native stream is closed
+    if (reader.cancelled)
+    {
+      tanker_stream_read_operation_finish(op, -1);
+      return;
+    }
     if (reader.stream.hasBytesAvailable)
       [reader performRead:out maxLength:n readOperation:op];
     else
     {
-      if (reader.stream.streamStatus == NSStreamStatusClosed)
+      // the input stream is closed on readQueue, it can still be at its end or in error here
+      NSStreamStatus const status = reader.stream.streamStatus;
+      if (status == NSStreamStatusClosed || status == NSStreamStatusAtEnd || status == NSStreamStatusError)
       {
-        if (reader.stream.streamError)
+        if (status == NSStreamStatusError || reader.stream.streamError)
           tanker_stream_read_operation_finish(op, -1);
         else
           tanker_stream_read_operation_finish(op, 0);
         // now we can release the reader created in encryptStream/decryptStream
-        (void)(__bridge_transfer TKRAsyncStreamReader*)additional_data;
+        [reader releaseFromNative];
       }
       reader.cOut = out;
       reader.cSize = n;
@@ -32,6 +42,18 @@ void readInput(uint8_t* _Nonnull out,
   });
 }
 
+@interface TKRAsyncStreamReader ()
+{
+  atomic_ullong _processedBytes;
+}
+
+@property(readwrite) BOOL cancelled;
+@property BOOL releasedFromNative;
+// reads and closes the input stream one after the other, so that it is never closed during a read
+@property(nonnull) dispatch_queue_t readQueue;
+
+@end
+
 @implementation TKRAsyncStreamReader
 
 + (nullable instancetype)readerWithStream:(nonnull NSInputStream*)stream
@@ -47,16 +69,67 @@ void readInput(uint8_t* _Nonnull out,
     self.cOp = nil;
     self.cOut = nil;
     self.cSize = 0;
+    self.readQueue = dispatch_queue_create("io.tanker.stream-reader", DISPATCH_QUEUE_SERIAL);
+    atomic_init(&_processedBytes, 0);
   }
   return self;
 }
 
+- (void)cancel
+{
+  // set before closing, so that a read racing with the close is not taken as the end of the input
+  self.cancelled = YES;
+  [self closeStream];
+  [self.stream removeFromRunLoop:[NSRunLoop mainRunLoop] forMode:NSDefaultRunLoopMode];
+  self.progressHandler = nil;
+  if (self.cOp && self.cOut)
+  {
+    tanker_stream_read_operation_finish(self.cOp, -1);
+    self.cOut = nil;
+    self.cOp = nil;
+    self.cSize = 0;
+  }
+}
+
+- (void)closeStream
+{
+  NSInputStream* stream = self.stream;
+  dispatch_async(self.readQueue, ^{
+    [stream close];
+  });
+}
+
+- (void)releaseFromNative
+{
+  if (self.releasedFromNative)
+    return;
+  self.releasedFromNative = YES;
+  CFBridgingRelease((__bridge CFTypeRef)self);
+}
+
+- (void)reportProgress:(NSInteger)nbRead
+{
+  TKRStreamProgressHandler handler = self.progressHandler;
+  dispatch_queue_t queue = self.progressQueue;
+  uint64_t const processed = atomic_fetch_add(&_processedBytes, (uint64_t)nbRead) + (uint64_t)nbRead;
+  if (!handler || !queue)
+    return;
+  dispatch_async(queue, ^{
+    handler(processed);
+  });
+}
+
 - (void)performRead:(nonnull uint8_t*)out
           maxLength:(int64_t)len
       readOperation:(nonnull tanker_stream_read_operation_t*)op;
 {
-  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-    tanker_stream_read_operation_finish(op, [self.stream read:out maxLength:(NSUInteger)len]);
+  dispatch_async(self.readQueue, ^{
+    NSInteger nbRead = [self.stream read:out maxLength:(NSUInteger)len];
+    if (self.cancelled)
+      nbRead = -1;
+    else if (nbRead > 0)
+      [self reportProgress:nbRead];
+    tanker_stream_read_operation_finish(op, nbRead);
   });
 }
 
@@ -91,7 +164,7 @@ void readInput(uint8_t* _Nonnull out,
       self.cOp = nil;
       self.cSize = 0;
     }
-    [aStream close];
+    [self closeStream];
   }
   break;
   case NSStreamEventErrorOccurred:
@@ -103,7 +176,7 @@ void readInput(uint8_t* _Nonnull out,
       self.cOp = nil;
       self.cSize = 0;
     }
-    [aStream close];
+    [self closeStream];
   }
   break;
   case NSStreamEventOpenCompleted:
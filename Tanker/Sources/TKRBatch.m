@@ -0,0 +1,168 @@
+#import <Tanker/TKRBatch+Private.h>
+#import <Tanker/TKRCancellationToken+Private.h>
+#import <Tanker/TKRDataResult+Private.h>
+#import <Tanker/Utils/TKRUtils.h>
+
+#include <Tanker/ctanker.h>
+
+@interface TKRBatchContext ()
+
+@property(nonnull) NSMutableArray<TKRDataResult*>* results;
+@property NSUInteger remaining;
+@property(nonnull) dispatch_queue_t queue;
+@property(nonnull) TKRBatchDataHandler handler;
+@property(readwrite, getter=isCancelled) BOOL cancelled;
+// Set once by the last result or by cancel, which then call the handler
+@property BOOL finished;
+@property(nullable) TKRCancellationToken* token;
+@property(nullable) id tokenRegistration;
+
+@end
+
+@implementation TKRBatchContext
+
++ (nonnull instancetype)batchWithCount:(NSUInteger)count
+                                 queue:(nonnull dispatch_queue_t)queue
+                               handler:(nonnull TKRBatchDataHandler)handler
+{
+  TKRBatchContext* batch = [[TKRBatchContext alloc] init];
+  batch.results = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; ++i)
+    [batch.results addObject:[[TKRDataResult alloc] init]];
+  batch.remaining = count;
+  batch.queue = queue;
+  batch.handler = handler;
+  return batch;
+}
+
+- (void)bindCancellationToken:(nullable TKRCancellationToken*)token
+{
+  if (!token)
+    return;
+  __weak TKRBatchContext* weakSelf = self;
+  id registration = [token addCancellationHandler:^{
+    [weakSelf cancel];
+  }];
+  @synchronized(self)
+  {
+    if (self.finished)
+    {
+      [token removeCancellationHandler:registration];
+      return;
+    }
+    self.token = token;
+    self.tokenRegistration = registration;
+  }
+}
+
+- (void)cancel
+{
+  @synchronized(self)
+  {
+    if (self.finished)
+      return;
+    self.finished = YES;
+    self.cancelled = YES;
+    for (NSUInteger i = 0; i < self.results.count; ++i)
+    {
+      if (!self.results[i].data && !self.results[i].error)
+        self.results[i].error = TKR_createCanceledError();
+    }
+  }
+  [self finish];
+}
+
+- (void)setResult:(nonnull TKRDataResult*)result atIndex:(NSUInteger)index
+{
+  BOOL done;
+  @synchronized(self)
+  {
+    // the batch was cancelled, the result is dropped
+    if (self.finished)
+      return;
+    self.results[index] = result;
+    done = --self.remaining == 0;
+    self.finished = done;
+  }
+  if (!done)
+    return;
+  [self finish];
+}
+
+- (void)finish
+{
+  TKRBatchDataHandler handler;
+  NSArray<TKRDataResult*>* results;
+  TKRCancellationToken* token;
+  id registration;
+  @synchronized(self)
+  {
+    handler = self.handler;
+    results = [self.results copy];
+    token = self.token;
+    registration = self.tokenRegistration;
+    self.token = nil;
+    self.tokenRegistration = nil;
+  }
+  if (token)
+    [token removeCancellationHandler:registration];
+
+  TKR_runOnQueue(self.queue, ^{
+    handler(results);
+  });
+}
+
+- (void)setData:(nonnull NSData*)data atIndex:(NSUInteger)index
+{
+  TKRDataResult* result = [[TKRDataResult alloc] init];
+  result.data = data;
+  [self setResult:result atIndex:index];
+}
+
+- (void)setError:(nonnull NSError*)error atIndex:(NSUInteger)index
+{
+  TKRDataResult* result = [[TKRDataResult alloc] init];
+  result.error = error;
+  [self setResult:result atIndex:index];
+}
+
+@end
+
+@implementation TKRBatchItem
+
++ (nonnull instancetype)itemWithBatch:(nonnull TKRBatchContext*)batch
+                                index:(NSUInteger)index
+                                input:(nonnull NSData*)input
+                               buffer:(nonnull uint8_t*)buffer
+                                 size:(uint64_t)size
+{
+  TKRBatchItem* item = [[TKRBatchItem alloc] init];
+  item.batch = batch;
+  item.index = index;
+  item.input = input;
+  item.buffer = buffer;
+  item.size = size;
+  return item;
+}
+
+@end
+
+void* TKR_resolveBatchItem(void* future, void* arg)
+{
+  TKRBatchItem* item = (__bridge_transfer TKRBatchItem*)arg;
+
+  NSError* err = TKR_getOptionalFutureError(future);
+  if (err)
+  {
+    free(item.buffer);
+    [item.batch setError:err atIndex:item.index];
+    return nil;
+  }
+
+  uint64_t size = item.size;
+  if (size == 0)
+    size = (uint64_t)(uintptr_t)tanker_future_get_voidptr((tanker_future_t*)future);
+  NSData* ret = [NSData dataWithBytesNoCopy:item.buffer length:(NSUInteger)size freeWhenDone:YES];
+  [item.batch setData:ret atIndex:item.index];
+  return nil;
+}
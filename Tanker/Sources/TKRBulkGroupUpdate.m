@@ -0,0 +1,311 @@
+#import <Tanker/TKRBulkGroupUpdate+Private.h>
+#import <Tanker/TKRCancellationToken+Private.h>
+#import <Tanker/TKRError.h>
+#import <Tanker/TKRGroupUpdateResult+Private.h>
+#import <Tanker/TKRTanker+Private.h>
+#import <Tanker/Utils/TKRUtils.h>
+
+#include <Tanker/ctanker.h>
+
+// Identities of one native call, converted to C strings
+@interface TKRGroupUpdateChunk : NSObject
+
+// The first chunk creates the group when there is no group ID
+@property BOOL createsGroup;
+@property NSRange addRange;
+@property NSRange removeRange;
+@property(nullable) char** identitiesToAdd;
+@property(nullable) char** identitiesToRemove;
+
+@end
+
+@implementation TKRGroupUpdateChunk
+
+- (void)dealloc
+{
+  if (_identitiesToAdd)
+    TKR_freeCStringArray(_identitiesToAdd, _addRange.length);
+  if (_identitiesToRemove)
+    TKR_freeCStringArray(_identitiesToRemove, _removeRange.length);
+}
+
+@end
+
+@interface TKRBulkGroupUpdate ()
+
+@property(nonnull) TKRTanker* tanker;
+@property(nullable) NSString* groupID;
+@property(nonnull) NSArray<NSString*>* usersToAdd;
+@property(nonnull) NSArray<NSString*>* usersToRemove;
+@property NSUInteger chunkSize;
+@property(nullable) TKRGroupUpdateProgressHandler progressHandler;
+@property(nonnull) TKRGroupUpdateResultHandler handler;
+@property(nonnull) dispatch_queue_t queue;
+@property(nullable) TKRCancellationToken* token;
+@property(nullable) id tokenRegistration;
+
+// Where the next chunk starts
+@property NSUInteger nextAdd;
+@property NSUInteger nextRemove;
+@property NSUInteger processed;
+// Prepared while the current chunk is in flight
+@property(nullable) TKRGroupUpdateChunk* nextChunk;
+@property(nullable) NSError* nextChunkError;
+// No chunk is sent once set
+@property BOOL cancelled;
+
+@end
+
+@implementation TKRBulkGroupUpdate
+
++ (nonnull instancetype)updateWithTanker:(nonnull TKRTanker*)tanker
+                                 groupID:(nullable NSString*)groupID
+                              usersToAdd:(nonnull NSArray<NSString*>*)usersToAdd
+                           usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
+                               chunkSize:(NSUInteger)chunkSize
+                       cancellationToken:(nullable TKRCancellationToken*)token
+                         progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+                       completionHandler:(nonnull TKRGroupUpdateResultHandler)handler
+{
+  TKRBulkGroupUpdate* update = [[TKRBulkGroupUpdate alloc] init];
+  update.tanker = tanker;
+  update.groupID = groupID;
+  update.usersToAdd = [usersToAdd copy];
+  update.usersToRemove = [usersToRemove copy];
+  update.chunkSize = chunkSize ?: 1000;
+  update.progressHandler = progressHandler;
+  update.handler = handler;
+  update.queue = dispatch_queue_create("io.tanker.group-update", DISPATCH_QUEUE_SERIAL);
+  update.token = token;
+  return update;
+}
+
+- (NSUInteger)totalCount
+{
+  return self.usersToAdd.count + self.usersToRemove.count;
+}
+
+// The chunks after the first update the group, which only its members can do
+- (BOOL)putOwnIdentityInFirstChunk
+{
+  NSString* ownIdentity = self.tanker.publicIdentity;
+  // without a started user, the native creation fails
+  if (self.usersToAdd.count <= self.chunkSize || !ownIdentity)
+    return YES;
+  NSUInteger const index = [self.usersToAdd indexOfObject:ownIdentity];
+  if (index == NSNotFound)
+    return NO;
+  if (index >= self.chunkSize)
+  {
+    NSMutableArray<NSString*>* usersToAdd = [self.usersToAdd mutableCopy];
+    [usersToAdd exchangeObjectAtIndex:index withObjectAtIndex:0];
+    self.usersToAdd = usersToAdd;
+  }
+  return YES;
+}
+
+- (void)start
+{
+  if (!self.groupID && ![self putOwnIdentityInFirstChunk])
+  {
+    NSError* err = TKR_createNSError(TKRErrorInvalidArgument,
+                                     @"the public identity of the current user must be in the identities of a group "
+                                     @"created in several chunks");
+    dispatch_async(self.queue, ^{
+      [self finishWithError:err pendingAdd:0 pendingRemove:0];
+    });
+    return;
+  }
+  if (self.token)
+  {
+    __weak TKRBulkGroupUpdate* weakSelf = self;
+    // an already cancelled token runs the handler right away, before the first chunk is prepared on the queue
+    self.tokenRegistration = [self.token addCancellationHandler:^{
+      TKRBulkGroupUpdate* update = weakSelf;
+      if (!update)
+        return;
+      dispatch_async(update.queue, ^{
+        [update cancelOnQueue];
+      });
+    }];
+  }
+  if (self.groupID)
+  {
+    NSMutableDictionary* groups = self.tanker.runningGroupUpdates;
+    @synchronized(groups)
+    {
+      NSMutableArray* waiting = groups[self.groupID];
+      if (waiting)
+      {
+        [waiting addObject:self];
+        return;
+      }
+      groups[self.groupID] = [NSMutableArray array];
+    }
+  }
+  dispatch_async(self.queue, ^{
+    [self prepareNextChunk];
+    [self sendNextChunk];
+  });
+}
+
+// Must be called on the queue
+- (void)cancelOnQueue
+{
+  self.cancelled = YES;
+  // the prepared chunk is not sent, its identities are pending again
+  TKRGroupUpdateChunk* chunk = self.nextChunk;
+  if (!chunk)
+    return;
+  self.nextAdd = chunk.addRange.location;
+  self.nextRemove = chunk.removeRange.location;
+  self.nextChunk = nil;
+}
+
+// Must be called on the queue
+- (void)prepareNextChunk
+{
+  self.nextChunk = nil;
+  if (self.cancelled)
+    return;
+  BOOL const createsGroup = !self.groupID && self.nextAdd == 0;
+  // creating a group without members is left to the native error
+  if (!createsGroup && self.nextAdd == self.usersToAdd.count && self.nextRemove == self.usersToRemove.count)
+    return;
+
+  TKRGroupUpdateChunk* chunk = [[TKRGroupUpdateChunk alloc] init];
+  chunk.createsGroup = createsGroup;
+  NSUInteger const addCount = MIN(self.chunkSize, self.usersToAdd.count - self.nextAdd);
+  // the group is created with additions only
+  NSUInteger const removeCount =
+      createsGroup ? 0 : MIN(self.chunkSize - addCount, self.usersToRemove.count - self.nextRemove);
+  chunk.addRange = NSMakeRange(self.nextAdd, addCount);
+  chunk.removeRange = NSMakeRange(self.nextRemove, removeCount);
+
+  NSError* err = nil;
+  chunk.identitiesToAdd = TKR_convertStringstoCStrings([self.usersToAdd subarrayWithRange:chunk.addRange], &err);
+  if (!err)
+    chunk.identitiesToRemove =
+        TKR_convertStringstoCStrings([self.usersToRemove subarrayWithRange:chunk.removeRange], &err);
+  if (err)
+  {
+    self.nextChunkError = err;
+    return;
+  }
+  self.nextAdd += addCount;
+  self.nextRemove += removeCount;
+  self.nextChunk = chunk;
+}
+
+// Must be called on the queue
+- (void)sendNextChunk
+{
+  TKRGroupUpdateChunk* chunk = self.nextChunk;
+  if (!chunk)
+  {
+    BOOL const pending = self.nextAdd < self.usersToAdd.count || self.nextRemove < self.usersToRemove.count;
+    NSError* err = self.cancelled && pending ? TKR_createCanceledError() : self.nextChunkError;
+    [self finishWithError:err pendingAdd:self.nextAdd pendingRemove:self.nextRemove];
+    return;
+  }
+
+  BOOL const creating = chunk.createsGroup;
+  TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
+    if (err)
+    {
+      [self finishWithError:err pendingAdd:chunk.addRange.location pendingRemove:chunk.removeRange.location];
+      return;
+    }
+    if (creating)
+    {
+      char* group_id = (char*)TKR_numberToPtr(ptrValue);
+      self.groupID = [NSString stringWithCString:group_id encoding:NSUTF8StringEncoding];
+      tanker_free_buffer(group_id);
+    }
+    self.processed += chunk.addRange.length + chunk.removeRange.length;
+    [self reportProgress];
+    [self sendNextChunk];
+  };
+
+  tanker_future_t* future;
+  if (creating)
+    future = tanker_create_group(
+        (tanker_t*)self.tanker.cTanker, (char const* const*)chunk.identitiesToAdd, chunk.addRange.length);
+  else
+    future = tanker_update_group_members((tanker_t*)self.tanker.cTanker,
+                                         [self.groupID cStringUsingEncoding:NSUTF8StringEncoding],
+                                         (char const* const*)chunk.identitiesToAdd,
+                                         chunk.addRange.length,
+                                         (char const* const*)chunk.identitiesToRemove,
+                                         chunk.removeRange.length);
+  tanker_future_t* resolve_future =
+      tanker_future_then(future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.queue));
+  tanker_future_destroy(future);
+  tanker_future_destroy(resolve_future);
+
+  // converted while this chunk is in flight, the adapter runs on the queue after it
+  [self prepareNextChunk];
+}
+
+- (void)reportProgress
+{
+  TKRGroupUpdateProgressHandler progressHandler = self.progressHandler;
+  if (!progressHandler)
+    return;
+  NSUInteger const processed = self.processed;
+  NSUInteger const total = self.totalCount;
+  TKR_runOnQueue(self.tanker.completionQueue, ^{
+    progressHandler(processed, total);
+  });
+}
+
+// Must be called on the queue
+- (void)finishWithError:(nullable NSError*)err pendingAdd:(NSUInteger)pendingAdd pendingRemove:(NSUInteger)pendingRemove
+{
+  self.nextChunk = nil;
+  if (self.tokenRegistration)
+    [self.token removeCancellationHandler:self.tokenRegistration];
+  self.tokenRegistration = nil;
+  TKRGroupUpdateResult* result = [[TKRGroupUpdateResult alloc] init];
+  result.groupID = self.groupID;
+  result.error = err;
+  result.pendingUsersToAdd =
+      [self.usersToAdd subarrayWithRange:NSMakeRange(pendingAdd, self.usersToAdd.count - pendingAdd)];
+  result.pendingUsersToRemove =
+      [self.usersToRemove subarrayWithRange:NSMakeRange(pendingRemove, self.usersToRemove.count - pendingRemove)];
+
+  TKRGroupUpdateResultHandler handler = self.handler;
+  TKR_runOnQueue(self.tanker.completionQueue, ^{
+    handler(result);
+  });
+
+  [self startNextUpdateOfGroup];
+}
+
+- (void)startNextUpdateOfGroup
+{
+  // a group being created cannot have been given to another update
+  if (!self.groupID)
+    return;
+  NSMutableDictionary* groups = self.tanker.runningGroupUpdates;
+  TKRBulkGroupUpdate* next = nil;
+  @synchronized(groups)
+  {
+    NSMutableArray* waiting = groups[self.groupID];
+    if (!waiting)
+      return;
+    if (waiting.count == 0)
+    {
+      [groups removeObjectForKey:self.groupID];
+      return;
+    }
+    next = waiting.firstObject;
+    [waiting removeObjectAtIndex:0];
+  }
+  dispatch_async(next.queue, ^{
+    [next prepareNextChunk];
+    [next sendNextChunk];
+  });
+}
+
+@end
@@ -0,0 +1,67 @@
+#import <Tanker/TKRCancellationToken+Private.h>
+#import <Tanker/TKRError.h>
+#import <Tanker/Utils/TKRUtils.h>
+
+NSError* _Nonnull TKR_createCanceledError(void)
+{
+  return TKR_createNSError(TKRErrorOperationCanceled, @"operation canceled");
+}
+
+@interface TKRCancellationToken ()
+
+// guarded by self
+@property(readwrite, getter=isCancelled) BOOL cancelled;
+@property(nonnull) NSMutableDictionary<NSNumber*, dispatch_block_t>* handlers;
+@property NSUInteger lastRegistration;
+
+@end
+
+@implementation TKRCancellationToken
+
++ (nonnull instancetype)token
+{
+  TKRCancellationToken* ret = [[self alloc] init];
+  ret.handlers = [NSMutableDictionary dictionary];
+  return ret;
+}
+
+- (void)cancel
+{
+  NSArray<dispatch_block_t>* handlers;
+  @synchronized(self)
+  {
+    if (self.cancelled)
+      return;
+    self.cancelled = YES;
+    handlers = self.handlers.allValues;
+    [self.handlers removeAllObjects];
+  }
+  for (dispatch_block_t handler in handlers)
+    handler();
+}
+
+- (nonnull id)addCancellationHandler:(nonnull dispatch_block_t)handler
+{
+  NSNumber* registration;
+  @synchronized(self)
+  {
+    registration = @(++self.lastRegistration);
+    if (!self.cancelled)
+    {
+      self.handlers[registration] = handler;
+      return registration;
+    }
+  }
+  handler();
+  return registration;
+}
+
+- (void)removeCancellationHandler:(nonnull id)registration
+{
+  @synchronized(self)
+  {
+    [self.handlers removeObjectForKey:registration];
+  }
+}
+
+@end
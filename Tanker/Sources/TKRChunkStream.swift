@@ -0,0 +1,394 @@
+import Foundation
+
+// Native streams hand out data by chunks of 1MB, reading less would only split them
+private let ChunkStreamReadSize = 1024 * 1024;
+
+// Runs source ahead of its consumer, keeping at most depth chunks in memory.
+// The owner must call cancel() when it goes away, the producing task keeps the prefetcher alive until then.
+@available(iOS 13.0, *)
+internal final class Prefetcher {
+  private typealias Chunk = Result<Data?, Swift.Error>;
+
+  private let lock = NSLock();
+  private let depth: Int;
+  private var chunks: [Chunk] = [];
+  private var consumer: CheckedContinuation<Chunk, Never>?;
+  private var producer: CheckedContinuation<Void, Never>?;
+  private var cancelled = false;
+  private var ended = false;
+  private var task: Task<Void, Never>?;
+
+  init(depth: Int, source: @escaping () async throws -> Data?) {
+    precondition(depth > 0, "prefetch depth must be positive");
+    self.depth = depth;
+    self.task = Task {
+      while true {
+        let chunk: Chunk;
+        do {
+          chunk = .success(try await source());
+        } catch {
+          chunk = .failure(error);
+        }
+        guard await self.push(chunk), case .success(.some) = chunk else {
+          return;
+        }
+      }
+    };
+  }
+
+  func cancel() {
+    lock.lock();
+    cancelled = true;
+    chunks.removeAll();
+    let producer = self.producer;
+    self.producer = nil;
+    lock.unlock();
+    producer?.resume();
+    task?.cancel();
+  }
+
+  // Must not be called concurrently
+  func next() async throws -> Data? {
+    if ended {
+      return nil;
+    }
+    let chunk = await withCheckedContinuation { (continuation: CheckedContinuation<Chunk, Never>) in
+      lock.lock();
+      let producer = self.producer;
+      self.producer = nil;
+      if chunks.isEmpty {
+        consumer = continuation;
+        lock.unlock();
+      } else {
+        let chunk = chunks.removeFirst();
+        lock.unlock();
+        continuation.resume(returning: chunk);
+      }
+      producer?.resume();
+    };
+    guard case .success(.some) = chunk else {
+      ended = true;
+      return try chunk.get();
+    }
+    return try chunk.get();
+  }
+
+  // Returns false when the prefetcher was cancelled
+  private func push(_ chunk: Chunk) async -> Bool {
+    await withCheckedContinuation { (continuation: CheckedContinuation<Void, Never>) in
+      lock.lock();
+      if cancelled || consumer != nil || chunks.count < depth {
+        lock.unlock();
+        continuation.resume();
+      } else {
+        producer = continuation;
+        lock.unlock();
+      }
+    };
+    lock.lock();
+    if cancelled {
+      lock.unlock();
+      return false;
+    }
+    if let consumer = self.consumer {
+      self.consumer = nil;
+      lock.unlock();
+      consumer.resume(returning: chunk);
+    } else {
+      chunks.append(chunk);
+      lock.unlock();
+    }
+    return true;
+  }
+}
+
+// Feeds a native stream. Native streams do at most one read operation at the same time.
+@available(iOS 13.0, *)
+internal class StreamInput {
+  // Set when the input failed, so that the error is reported instead of the native one
+  var error: Swift.Error?;
+
+  func read(into out: UnsafeMutablePointer<UInt8>, count: Int, operation: OpaquePointer) {
+    fatalError("StreamInput.read must be overridden");
+  }
+
+  func fail(_ error: Swift.Error, operation: OpaquePointer) {
+    self.error = error;
+    tanker_stream_read_operation_finish(operation, -1);
+  }
+}
+
+// Reads chunks from an async source, keeping the part of a chunk that did not fit in the native buffer
+@available(iOS 13.0, *)
+internal final class AsyncSequenceInput: StreamInput {
+  private let nextChunk: () async throws -> Data?;
+  private let prefetcher: Prefetcher?;
+  private var pending = Data();
+
+  init(readAhead: Int, nextChunk: @escaping () async throws -> Data?) {
+    if readAhead > 0 {
+      let prefetcher = Prefetcher(depth: readAhead, source: nextChunk);
+      self.prefetcher = prefetcher;
+      self.nextChunk = { try await prefetcher.next() };
+    } else {
+      self.prefetcher = nil;
+      self.nextChunk = nextChunk;
+    }
+  }
+
+  convenience init<S: AsyncSequence>(_ chunks: S, readAhead: Int) where S.Element == Data {
+    var iterator = chunks.makeAsyncIterator();
+    self.init(readAhead: readAhead, nextChunk: { try await iterator.next() });
+  }
+
+  deinit {
+    prefetcher?.cancel();
+  }
+
+  override func read(into out: UnsafeMutablePointer<UInt8>, count: Int, operation: OpaquePointer) {
+    Task {
+      do {
+        while self.pending.isEmpty {
+          guard let chunk = try await self.nextChunk() else {
+            tanker_stream_read_operation_finish(operation, 0);
+            return;
+          }
+          self.pending = chunk;
+        }
+        let nbRead = min(count, self.pending.count);
+        self.pending.copyBytes(to: out, count: nbRead);
+        self.pending.removeFirst(nbRead);
+        tanker_stream_read_operation_finish(operation, Int64(nbRead));
+      } catch {
+        self.fail(error, operation: operation);
+      }
+    }
+  }
+}
+
+// Reads from an InputStream with blocking reads on a private queue, without scheduling it on a run loop
+@available(iOS 13.0, *)
+internal final class InputStreamInput: StreamInput {
+  private let stream: InputStream;
+  private let queue = DispatchQueue(label: "io.tanker.stream-input");
+
+  init(_ stream: InputStream) {
+    self.stream = stream;
+    stream.open();
+  }
+
+  deinit {
+    stream.close();
+  }
+
+  private func readError() -> Swift.Error {
+    return self.stream.streamError ?? TKR_createNSError(UInt(Error.ioError.rawValue), "could not read input stream") as NSError;
+  }
+
+  override func read(into out: UnsafeMutablePointer<UInt8>, count: Int, operation: OpaquePointer) {
+    queue.async {
+      let nbRead = self.stream.read(out, maxLength: count);
+      if nbRead < 0 {
+        self.fail(self.readError(), operation: operation);
+      } else {
+        tanker_stream_read_operation_finish(operation, Int64(nbRead));
+      }
+    }
+  }
+
+  // Same blocking reads, by chunks, to be read ahead
+  func nextChunk() async throws -> Data? {
+    return try await withCheckedThrowingContinuation { continuation in
+      queue.async {
+        var chunk = Data(count: ChunkStreamReadSize);
+        let nbRead = chunk.withUnsafeMutableBytes {
+          self.stream.read($0.bindMemory(to: UInt8.self).baseAddress!, maxLength: ChunkStreamReadSize)
+        };
+        if nbRead < 0 {
+          continuation.resume(throwing: self.readError());
+        } else if nbRead == 0 {
+          continuation.resume(returning: nil);
+        } else {
+          chunk.count = nbRead;
+          continuation.resume(returning: chunk);
+        }
+      }
+    }
+  }
+}
+
+@available(iOS 13.0, *)
+internal func makeStreamInput(_ stream: InputStream, readAhead: Int) -> StreamInput {
+  let input = InputStreamInput(stream);
+  if readAhead == 0 {
+    return input;
+  }
+  return AsyncSequenceInput(readAhead: readAhead, nextChunk: { try await input.nextChunk() });
+}
+
+@available(iOS 13.0, *)
+func readStreamInput(_ out: UnsafeMutablePointer<UInt8>?, _ n: Int64, _ op: OpaquePointer?, _ data: UnsafeMutableRawPointer?) {
+  let input = Unmanaged<StreamInput>.fromOpaque(data!).takeUnretainedValue();
+  input.read(into: out!, count: Int(n), operation: op!);
+}
+
+private func releaseRetainedObject(_ fut: OpaquePointer?, _ arg: UnsafeMutableRawPointer?) -> UnsafeMutableRawPointer? {
+  Unmanaged<AnyObject>.fromOpaque(arg!).release();
+  return nil;
+}
+
+// The input must outlive the native stream, it can still be read from until the stream is closed
+@available(iOS 13.0, *)
+internal func closeNativeStream(_ cStream: OpaquePointer, input: StreamInput) {
+  let closeFuture = tanker_stream_close(cStream)!;
+  let releaseFuture = tanker_future_then(closeFuture, releaseRetainedObject, Unmanaged.passRetained(input as AnyObject).toOpaque());
+  tanker_future_destroy(closeFuture);
+  tanker_future_destroy(releaseFuture);
+}
+
+// Awaits the creation of a native stream fed by input
+@available(iOS 13.0, *)
+internal func awaitChunkStream(_ streamFuture: OpaquePointer, input: StreamInput, readAhead: Int) async throws -> ChunkStream {
+  let cStream = try await awaitFuture(streamFuture, keepAlive: [input], discardResult: { cStream in
+    closeNativeStream(OpaquePointer(cStream!), input: input);
+  })!;
+  return ChunkStream(reader: NativeStreamReader(cStream: OpaquePointer(cStream), input: input), readAhead: readAhead);
+}
+
+// Owns a native stream, and closes it when released
+@available(iOS 13.0, *)
+internal final class NativeStreamReader {
+  private let cStream: OpaquePointer;
+  private let input: StreamInput;
+  private var finished = false;
+
+  init(cStream: OpaquePointer, input: StreamInput) {
+    self.cStream = cStream;
+    self.input = input;
+  }
+
+  deinit {
+    closeNativeStream(cStream, input: input);
+  }
+
+  // Must not be called concurrently
+  func readChunk() async throws -> Data? {
+    if finished {
+      return nil;
+    }
+    let buffer = try NativeBuffer(size: UInt64(ChunkStreamReadSize));
+    let readFuture = tanker_stream_read(cStream, buffer.pointer, Int64(ChunkStreamReadSize))!;
+    let nbRead: UnsafeMutableRawPointer?;
+    do {
+      nbRead = try await awaitFuture(readFuture, keepAlive: [buffer, self]);
+    } catch {
+      // a cancelled read may still be running, do not start another one
+      finished = true;
+      throw input.error ?? error;
+    }
+    let count = Int(bitPattern: nbRead);
+    if count == 0 {
+      finished = true;
+      return nil;
+    }
+    return buffer.toData(count: count);
+  }
+}
+
+// An encrypted or decrypted stream, as an AsyncSequence of Data chunks.
+//
+// Chunks are read from the native stream when they are asked for, so a slow consumer slows the input down.
+// With a positive readAhead, up to readAhead chunks are read from the input and from the native stream before
+// they are asked for, so that reading the input, encrypting and consuming the output overlap.
+// It must be iterated only once, by a single task.
+@available(iOS 13.0, *)
+public final class ChunkStream: AsyncSequence {
+  public typealias Element = Data;
+
+  private let reader: NativeStreamReader;
+  private let prefetcher: Prefetcher?;
+
+  internal init(reader: NativeStreamReader, readAhead: Int) {
+    self.reader = reader;
+    self.prefetcher = readAhead > 0 ? Prefetcher(depth: readAhead, source: { try await reader.readChunk() }) : nil;
+  }
+
+  deinit {
+    prefetcher?.cancel();
+  }
+
+  public struct AsyncIterator: AsyncIteratorProtocol {
+    fileprivate let stream: ChunkStream;
+
+    public mutating func next() async throws -> Data? {
+      if let prefetcher = stream.prefetcher {
+        return try await prefetcher.next();
+      }
+      return try await stream.reader.readChunk();
+    }
+  }
+
+  public func makeAsyncIterator() -> AsyncIterator {
+    return AsyncIterator(stream: self);
+  }
+}
+
+@available(iOS 13.0, *)
+public extension Tanker {
+  func encrypt<S: AsyncSequence>(chunks clearChunks: S,
+                                 options: EncryptionOptions = EncryptionOptions(),
+                                 readAhead: Int = 0) async throws -> ChunkStream where S.Element == Data {
+    return try await self.encryptStream(input: AsyncSequenceInput(clearChunks, readAhead: readAhead), options: options,
+                                        readAhead: readAhead);
+  }
+
+  func encrypt(stream clearStream: InputStream,
+               options: EncryptionOptions = EncryptionOptions(),
+               readAhead: Int = 0) async throws -> ChunkStream {
+    return try await self.encryptStream(input: makeStreamInput(clearStream, readAhead: readAhead), options: options,
+                                        readAhead: readAhead);
+  }
+
+  func decrypt<S: AsyncSequence>(chunks encryptedChunks: S, readAhead: Int = 0) async throws -> ChunkStream
+      where S.Element == Data {
+    return try await self.decryptStream(input: AsyncSequenceInput(encryptedChunks, readAhead: readAhead),
+                                        readAhead: readAhead);
+  }
+
+  func decrypt(stream encryptedStream: InputStream, readAhead: Int = 0) async throws -> ChunkStream {
+    return try await self.decryptStream(input: makeStreamInput(encryptedStream, readAhead: readAhead),
+                                        readAhead: readAhead);
+  }
+
+  private func encryptStream(input: StreamInput, options: EncryptionOptions, readAhead: Int) async throws -> ChunkStream {
+    let streamFuture = options.withCEncryptOptions { cOptionsPtr in
+      tanker_stream_encrypt(self.cTanker, readStreamInput, Unmanaged.passUnretained(input).toOpaque(), cOptionsPtr)!
+    }
+    return try await awaitChunkStream(streamFuture, input: input, readAhead: readAhead);
+  }
+
+  internal func decryptStream(input: StreamInput, readAhead: Int) async throws -> ChunkStream {
+    let streamFuture = tanker_stream_decrypt(self.cTanker, readStreamInput, Unmanaged.passUnretained(input).toOpaque())!;
+    return try await awaitChunkStream(streamFuture, input: input, readAhead: readAhead);
+  }
+}
+
+@available(iOS 13.0, *)
+public extension EncryptionSession {
+  func encrypt<S: AsyncSequence>(chunks clearChunks: S, readAhead: Int = 0) async throws -> ChunkStream
+      where S.Element == Data {
+    return try await self.encryptStream(input: AsyncSequenceInput(clearChunks, readAhead: readAhead),
+                                        readAhead: readAhead);
+  }
+
+  func encrypt(stream clearStream: InputStream, readAhead: Int = 0) async throws -> ChunkStream {
+    return try await self.encryptStream(input: makeStreamInput(clearStream, readAhead: readAhead),
+                                        readAhead: readAhead);
+  }
+
+  private func encryptStream(input: StreamInput, readAhead: Int) async throws -> ChunkStream {
+    let streamFuture = tanker_encryption_session_stream_encrypt(self.cSession, readStreamInput,
+                                                                Unmanaged.passUnretained(input).toOpaque())!;
+    return try await awaitChunkStream(streamFuture, input: input, readAhead: readAhead);
+  }
+}
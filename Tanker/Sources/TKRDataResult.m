@@ -0,0 +1,5 @@
+#import <Tanker/TKRDataResult+Private.h>
+
+@implementation TKRDataResult
+
+@end
@@ -1,5 +1,7 @@
 @objc(TKREncryptionOptions)
 public class EncryptionOptions: NSObject {
+  static let C_ENCRYPT_OPTIONS_VERSION: UInt8 = 4;
+
   @objc
   public var shareWithUsers: Array<String>;
   @objc
@@ -16,4 +18,20 @@ public class EncryptionOptions: NSObject {
     self.shareWithSelf = true;
     self.paddingStep = Padding.automatic()!;
   }
+
+  func withCEncryptOptions<R>(_ body: (UnsafePointer<tanker_encrypt_options_t>) throws -> R) rethrows -> R {
+    return try withCStrings(self.shareWithUsers) { cUsers in
+      try withCStrings(self.shareWithGroups) { cGroups in
+        var cOptions = tanker_encrypt_options_t();
+        cOptions.version = Self.C_ENCRYPT_OPTIONS_VERSION;
+        cOptions.share_with_users = cUsers;
+        cOptions.nb_users = UInt32(self.shareWithUsers.count);
+        cOptions.share_with_groups = cGroups;
+        cOptions.nb_groups = UInt32(self.shareWithGroups.count);
+        cOptions.share_with_self = self.shareWithSelf;
+        cOptions.padding_step = self.paddingStep.nativeValue.uint32Value;
+        return try body(&cOptions);
+      }
+    }
+  }
 }
@@ -1,5 +1,6 @@
 
 #import <Tanker/TKREncryptionSession+Private.h>
+#import <Tanker/TKRTracer+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
 
 #include <Tanker/ctanker/encryptionsession.h>
@@ -21,6 +22,18 @@
   return TKR_numberToPtr(objc_getAssociatedObject(self, @selector(cSession)));
 }
 
+@dynamic completionQueue;
+
+- (void)setCompletionQueue:(dispatch_queue_t)value
+{
+  objc_setAssociatedObject(self, @selector(completionQueue), value, OBJC_ASSOCIATION_RETAIN);
+}
+
+- (dispatch_queue_t)completionQueue
+{
+  return objc_getAssociatedObject(self, @selector(completionQueue)) ?: dispatch_get_main_queue();
+}
+
 - (void)encryptDataImpl:(nonnull NSData*)clearData
       completionHandler:(nonnull void (^)(TKRPtrAndSizePair* _Nullable, NSError* _Nullable))handler
 {
@@ -52,14 +65,15 @@
 
   if (!encrypted_buffer)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, TKR_createNSErrorWithDomain(NSPOSIXErrorDomain, ENOMEM, @"could not allocate encrypted buffer"));
     return;
   }
 
   tanker_future_t* encrypt_future = tanker_encryption_session_encrypt(
       (tanker_encryption_session_t*)self.cSession, encrypted_buffer, (uint8_t const*)clearData.bytes, clearData.length);
-  tanker_future_t* resolve_future =
-      tanker_future_then(encrypt_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      encrypt_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(encrypt_future);
   tanker_future_destroy(resolve_future);
   // Force clearData to be retained until the tanker_future is done
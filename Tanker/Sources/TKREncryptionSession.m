@@ -2,6 +2,7 @@
 #import <Tanker/TKREncryptionSession+Private.h>
 #import <Tanker/TKRError.h>
 #import <Tanker/TKRTanker+Private.h>
+#import <Tanker/TKRTracer+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
 
 #include <Tanker/ctanker/encryptionsession.h>
@@ -31,7 +32,7 @@
   NSData* data = TKR_convertStringToData(clearText, &err);
 
   if (err)
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(nil, err);
     });
   else
@@ -40,6 +41,7 @@
 
 - (void)encryptData:(nonnull NSData*)clearData completionHandler:(nonnull TKREncryptedDataHandler)handler
 {
+  TKR_TRACE_OPERATION();
   id adapter = ^(TKRPtrAndSizePair* hack, NSError* err) {
     if (err)
     {
@@ -56,15 +58,21 @@
 
 - (void)dealloc
 {
-  tanker_future_t* close_future = tanker_encryption_session_close((tanker_encryption_session_t*)self.cSession);
-  tanker_future_wait(close_future);
-  tanker_future_destroy(close_future);
+  tanker_encryption_session_t* c_session = (tanker_encryption_session_t*)self.cSession;
+  // Queued before the destruction of the TKRTanker, if it is released after the session
+  dispatch_async(TKR_lifecycleQueue(), ^{
+    tanker_future_t* close_future = tanker_encryption_session_close(c_session);
+    tanker_future_wait(close_future);
+    tanker_future_destroy(close_future);
+  });
 }
 
 - (void)encryptStream:(nonnull NSInputStream*)clearStream completionHandler:(nonnull TKRInputStreamHandler)handler
 {
+  TKR_TRACE_OPERATION();
   if (clearStream.streamStatus != NSStreamStatusNotOpen)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, TKR_createNSError(TKRErrorInvalidArgument, @"Input stream status must be NSStreamStatusNotOpen"));
     return;
   }
@@ -79,7 +87,7 @@
   tanker_future_t* stream_fut = tanker_encryption_session_stream_encrypt((tanker_encryption_session_t*)self.cSession,
                                                                          (tanker_stream_input_source_t)&readInput,
                                                                          (__bridge_retained void*)reader);
-  completeStreamEncrypt(reader, stream_fut, handler);
+  completeStreamEncrypt(reader, stream_fut, nil, self.completionQueue, handler);
   tanker_future_destroy(stream_fut);
 }
 
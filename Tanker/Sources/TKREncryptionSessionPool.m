@@ -0,0 +1,193 @@
+#import <Tanker/TKREncryptionSession.h>
+#import <Tanker/TKREncryptionSessionPool.h>
+#import <Tanker/TKRSwift+Private.h>
+#import <Tanker/TKRTanker+Private.h>
+#import <Tanker/Utils/TKRUtils.h>
+
+// A fresh session is opened in the background when the current one reaches this fraction of its limits
+static double const TKRPreopenFraction = 0.8;
+
+@interface TKRPooledSession : NSObject
+
+@property(nonnull) TKREncryptionSession* session;
+@property NSUInteger uses;
+@property NSTimeInterval openedAt;
+
+@end
+
+@implementation TKRPooledSession
+
+@end
+
+@interface TKRSessionPoolEntry : NSObject
+
+@property(nonnull) TKREncryptionOptions* options;
+@property(nullable) TKRPooledSession* current;
+// Pre-opened session, which becomes current on rotation
+@property(nullable) TKRPooledSession* next;
+@property BOOL opening;
+// Handlers waiting for the session being opened, when there is no current session
+@property(nonnull) NSMutableArray<TKREncryptionSessionHandler>* waiters;
+
+@end
+
+@implementation TKRSessionPoolEntry
+
+@end
+
+@interface TKREncryptionSessionPool ()
+
+@property(nonnull) TKRTanker* tanker;
+@property(nonnull) NSMutableDictionary<NSArray*, TKRSessionPoolEntry*>* entries;
+
+@end
+
+@implementation TKREncryptionSessionPool
+
++ (nonnull instancetype)poolWithTanker:(nonnull TKRTanker*)tanker
+{
+  TKREncryptionSessionPool* pool = [[TKREncryptionSessionPool alloc] init];
+  pool.tanker = tanker;
+  pool.entries = [NSMutableDictionary dictionary];
+  pool.maxUsesPerSession = 1000;
+  pool.maxSessionAge = 600;
+  return pool;
+}
+
+static NSArray* normalizedKey(TKREncryptionOptions* options)
+{
+  NSArray<NSString*>* users =
+      [[[NSSet setWithArray:options.shareWithUsers] allObjects] sortedArrayUsingSelector:@selector(compare:)];
+  NSArray<NSString*>* groups =
+      [[[NSSet setWithArray:options.shareWithGroups] allObjects] sortedArrayUsingSelector:@selector(compare:)];
+  return @[ users, groups, @(options.shareWithSelf), options.paddingStep.nativeValue ];
+}
+
+// Must be called with the lock held
+- (BOOL)isExpired:(TKRPooledSession*)pooled fraction:(double)fraction now:(NSTimeInterval)now
+{
+  if (self.maxUsesPerSession && pooled.uses >= self.maxUsesPerSession * fraction)
+    return YES;
+  return self.maxSessionAge > 0 && now - pooled.openedAt >= self.maxSessionAge * fraction;
+}
+
+- (void)encryptionSessionWithOptions:(nonnull TKREncryptionOptions*)options
+                   completionHandler:(nonnull TKREncryptionSessionHandler)handler
+{
+  NSArray* key = normalizedKey(options);
+  NSTimeInterval const now = [NSProcessInfo processInfo].systemUptime;
+  TKREncryptionSession* session = nil;
+  BOOL mustOpen = NO;
+  BOOL mustPreopen = NO;
+  TKRSessionPoolEntry* entry;
+
+  @synchronized(self)
+  {
+    entry = self.entries[key];
+    if (!entry)
+    {
+      entry = [[TKRSessionPoolEntry alloc] init];
+      // do not keep the caller's options, they could be modified later
+      entry.options = [[TKREncryptionOptions alloc] init];
+      entry.options.shareWithUsers = key[0];
+      entry.options.shareWithGroups = key[1];
+      entry.options.shareWithSelf = options.shareWithSelf;
+      entry.options.paddingStep = options.paddingStep;
+      entry.waiters = [NSMutableArray array];
+      self.entries[key] = entry;
+    }
+    if (entry.current && [self isExpired:entry.current fraction:1 now:now])
+    {
+      entry.current = entry.next;
+      entry.next = nil;
+    }
+    if (entry.current)
+    {
+      entry.current.uses += 1;
+      session = entry.current.session;
+      mustPreopen = !entry.next && !entry.opening && [self isExpired:entry.current fraction:TKRPreopenFraction now:now];
+      entry.opening = entry.opening || mustPreopen;
+    }
+    else
+    {
+      [entry.waiters addObject:handler];
+      mustOpen = !entry.opening;
+      entry.opening = YES;
+    }
+  }
+
+  if (session)
+    TKR_runOnQueue(self.tanker.completionQueue, ^{
+      handler(session, nil);
+    });
+  if (mustOpen || mustPreopen)
+    [self openSessionForEntry:entry key:key];
+}
+
+- (void)openSessionForEntry:(nonnull TKRSessionPoolEntry*)entry key:(nonnull NSArray*)key
+{
+  // the pool retains the tanker, not the other way around, capturing self is fine
+  [self.tanker createEncryptionSessionWithCompletionHandler:^(TKREncryptionSession* session, NSError* err) {
+    NSArray<TKREncryptionSessionHandler>* waiters;
+    @synchronized(self)
+    {
+      entry.opening = NO;
+      waiters = [entry.waiters copy];
+      [entry.waiters removeAllObjects];
+      if (session && self.entries[key] == entry)
+      {
+        TKRPooledSession* pooled = [[TKRPooledSession alloc] init];
+        pooled.session = session;
+        pooled.uses = waiters.count;
+        pooled.openedAt = [NSProcessInfo processInfo].systemUptime;
+        if (entry.current)
+          entry.next = pooled;
+        else
+          entry.current = pooled;
+      }
+    }
+    // we are already on the completion queue
+    for (TKREncryptionSessionHandler waiter in waiters)
+      waiter(session, err);
+  }
+                                          encryptionOptions:entry.options];
+}
+
+- (void)encryptData:(nonnull NSData*)clearData
+              options:(nonnull TKREncryptionOptions*)options
+    completionHandler:(nonnull TKREncryptedDataHandler)handler
+{
+  [self encryptionSessionWithOptions:options
+                   completionHandler:^(TKREncryptionSession* session, NSError* err) {
+                     if (err)
+                       handler(nil, err);
+                     else
+                       [session encryptData:clearData completionHandler:handler];
+                   }];
+}
+
+- (void)encryptString:(nonnull NSString*)clearText
+              options:(nonnull TKREncryptionOptions*)options
+    completionHandler:(nonnull TKREncryptedDataHandler)handler
+{
+  NSError* err = nil;
+  NSData* data = TKR_convertStringToData(clearText, &err);
+
+  if (err)
+    TKR_runOnQueue(self.tanker.completionQueue, ^{
+      handler(nil, err);
+    });
+  else
+    [self encryptData:data options:options completionHandler:handler];
+}
+
+- (void)removeAllSessions
+{
+  @synchronized(self)
+  {
+    // sessions being opened are handed to their waiters, but not kept
+    [self.entries removeAllObjects];
+  }
+}
+
+@end
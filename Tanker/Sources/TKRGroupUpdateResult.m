@@ -0,0 +1,5 @@
+#import <Tanker/TKRGroupUpdateResult+Private.h>
+
+@implementation TKRGroupUpdateResult
+
+@end
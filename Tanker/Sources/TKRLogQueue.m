@@ -0,0 +1,176 @@
+#import <Tanker/TKRLogQueue+Private.h>
+
+#include <stdatomic.h>
+#include <string.h>
+
+// Records are truncated to fit in their slot
+typedef struct
+{
+  _Atomic(uint64_t) sequence;
+  uint32_t level;
+  uint32_t line;
+  char category[64];
+  char file[256];
+  char message[1024];
+} TKRLogSlot;
+
+static TKRLogSlot* slots;
+static _Atomic(uint64_t) enqueuePosition;
+// only touched by the drain queue
+static uint64_t dequeuePosition;
+static _Atomic(uint64_t) droppedCount;
+static atomic_bool drainScheduled;
+// no handler was connected yet, the default one only shows errors
+static _Atomic(TKRLogLevel) minimumLevel = TKRLogLevelError;
+static atomic_bool minimumLevelSet;
+static dispatch_queue_t drainQueue;
+// only touched by the drain queue
+static TKRLogHandler logHandler;
+
+static void initLogQueue(void)
+{
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    slots = calloc(TKR_LOG_QUEUE_CAPACITY, sizeof(TKRLogSlot));
+    for (uint64_t i = 0; i < TKR_LOG_QUEUE_CAPACITY; ++i)
+      atomic_init(&slots[i].sequence, i);
+    drainQueue = dispatch_queue_create("io.tanker.logs", DISPATCH_QUEUE_SERIAL);
+    logHandler = ^(TKRLogEntry* _Nonnull entry) {
+      switch (entry.level)
+      {
+      case TKRLogLevelDebug:
+        break;
+      case TKRLogLevelInfo:
+        break;
+      case TKRLogLevelWarning:
+        break;
+      case TKRLogLevelError:
+        NSLog(@"Tanker Error: [%@] %@", entry.category, entry.message);
+        break;
+      default:
+        NSLog(@"Unknown Tanker log level: %c: [%@] %@", (int)entry.level, entry.category, entry.message);
+      }
+    };
+  });
+}
+
+// Copies src, truncated on a UTF-8 character boundary so that it can still be decoded
+static void copyTruncated(char* dst, size_t size, char const* src)
+{
+  size_t len = src ? strlen(src) : 0;
+  if (len >= size)
+  {
+    len = size - 1;
+    // do not cut a multi-byte character: back off its continuation bytes and its leading byte
+    while (len > 0 && ((unsigned char)src[len] & 0xC0) == 0x80)
+      --len;
+  }
+  memcpy(dst, src, len);
+  dst[len] = '\0';
+}
+
+static NSString* decodeString(char const* str)
+{
+  return [[NSString alloc] initWithUTF8String:str] ?: @"";
+}
+
+static void drain(void* unused)
+{
+  // cleared first, a record pushed while draining schedules another drain
+  atomic_store(&drainScheduled, false);
+  for (;;)
+  {
+    TKRLogSlot* slot = &slots[dequeuePosition % TKR_LOG_QUEUE_CAPACITY];
+    uint64_t const sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != dequeuePosition + 1)
+      return;
+
+    TKRLogEntry* entry = [[TKRLogEntry alloc] init];
+    entry.category = decodeString(slot->category);
+    entry.file = decodeString(slot->file);
+    entry.message = decodeString(slot->message);
+    entry.level = (TKRLogLevel)slot->level;
+    entry.line = slot->line;
+    // the slot can be reused from now on
+    atomic_store_explicit(&slot->sequence, dequeuePosition + TKR_LOG_QUEUE_CAPACITY, memory_order_release);
+    ++dequeuePosition;
+    @autoreleasepool
+    {
+      logHandler(entry);
+    }
+  }
+}
+
+void TKR_logQueuePush(tanker_log_record_t const* _Nonnull record)
+{
+  if (record->level < atomic_load_explicit(&minimumLevel, memory_order_relaxed))
+    return;
+  initLogQueue();
+
+  // bounded multi-producer queue, each slot sequence tells whether it is free for a given position
+  TKRLogSlot* slot;
+  uint64_t position = atomic_load_explicit(&enqueuePosition, memory_order_relaxed);
+  for (;;)
+  {
+    slot = &slots[position % TKR_LOG_QUEUE_CAPACITY];
+    uint64_t const sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    int64_t const diff = (int64_t)(sequence - position);
+    if (diff == 0)
+    {
+      if (atomic_compare_exchange_weak_explicit(
+              &enqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // full, the drain queue is behind
+      atomic_fetch_add_explicit(&droppedCount, 1, memory_order_relaxed);
+      return;
+    }
+    else
+      position = atomic_load_explicit(&enqueuePosition, memory_order_relaxed);
+  }
+
+  slot->level = record->level;
+  slot->line = record->line;
+  copyTruncated(slot->category, sizeof(slot->category), record->category);
+  copyTruncated(slot->file, sizeof(slot->file), record->file);
+  copyTruncated(slot->message, sizeof(slot->message), record->message);
+  atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+  if (!atomic_exchange(&drainScheduled, true))
+    dispatch_async_f(drainQueue, NULL, &drain);
+}
+
+void TKR_logQueueSetHandler(TKRLogHandler _Nonnull handler)
+{
+  initLogQueue();
+  // a connected handler gets every record, unless a minimum level was explicitly set
+  if (!atomic_load(&minimumLevelSet))
+    atomic_store(&minimumLevel, TKRLogLevelDebug);
+  dispatch_async(drainQueue, ^{
+    logHandler = handler;
+  });
+}
+
+void TKR_logQueueSetMinimumLevel(TKRLogLevel level)
+{
+  atomic_store(&minimumLevelSet, true);
+  atomic_store(&minimumLevel, level);
+}
+
+TKRLogLevel TKR_logQueueMinimumLevel(void)
+{
+  return atomic_load(&minimumLevel);
+}
+
+uint64_t TKR_logQueueDroppedCount(void)
+{
+  return atomic_load(&droppedCount);
+}
+
+void TKR_logQueueFlush(void)
+{
+  initLogQueue();
+  dispatch_sync_f(drainQueue, NULL, &drain);
+}
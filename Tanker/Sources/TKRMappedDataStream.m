@@ -0,0 +1,182 @@
+#import <Tanker/TKRError.h>
+#import <Tanker/TKRMappedDataStream+Private.h>
+#import <Tanker/TKRTracer+Private.h>
+#import <Tanker/Utils/TKRUtils.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Size of the reads from the native stream, the chunks of the stream formats are 1MiB
+#define TKR_MAPPED_STREAM_READ_SIZE (1024 * 1024)
+
+@interface TKRDataInput : NSObject
+
+@property(nonnull) NSData* data;
+@property NSUInteger offset;
+
+@end
+
+@implementation TKRDataInput
+@end
+
+static void readDataInput(uint8_t* _Nonnull out,
+                          int64_t n,
+                          tanker_stream_read_operation_t* _Nonnull op,
+                          void* _Nonnull additional_data)
+{
+  TKRDataInput* input = (__bridge typeof(TKRDataInput*))additional_data;
+  NSUInteger const offset = input.offset;
+  NSUInteger const count = MIN((NSUInteger)n, input.data.length - offset);
+  uint8_t const* bytes = (uint8_t const*)input.data.bytes;
+  memcpy(out, bytes + offset, count);
+  input.offset = offset + count;
+  tanker_stream_read_operation_finish(op, (int64_t)count);
+}
+
+static NSError* posixError(NSString* message)
+{
+  return TKR_createNSErrorWithDomain(
+      NSPOSIXErrorDomain, (NSUInteger)errno, [NSString stringWithFormat:@"%@: %s", message, strerror(errno)]);
+}
+
+static void* waitFuture(tanker_future_t* future, NSError** err)
+{
+  tanker_future_wait(future);
+  return TKR_unwrapAndFreeExpected(future, err);
+}
+
+// The file only becomes readable once the device is unlocked, since it can hold decrypted data
+static int createProtectedFile(NSString* path, NSError** err)
+{
+  NSDictionary* attributes = @{NSFileProtectionKey : NSFileProtectionComplete};
+  if (![[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:attributes])
+  {
+    *err = TKR_createNSError(TKRErrorInvalidArgument, [NSString stringWithFormat:@"could not create %@", path]);
+    return -1;
+  }
+  int const fd = open(path.fileSystemRepresentation, O_RDWR | O_TRUNC | O_CLOEXEC);
+  if (fd < 0)
+    *err = posixError(@"could not open destination file");
+  return fd;
+}
+
+static NSError* _Nullable writeAll(int fd, uint8_t const* buffer, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t const written = write(fd, buffer, size);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return posixError(@"could not write destination file");
+    }
+    buffer += written;
+    size -= (size_t)written;
+  }
+  return nil;
+}
+
+static NSData* _Nullable mapFile(int fd, NSError** err)
+{
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+  {
+    *err = posixError(@"could not stat destination file");
+    return nil;
+  }
+  if (st.st_size == 0)
+    return [NSData data];
+
+  void* bytes = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (bytes == MAP_FAILED)
+  {
+    *err = posixError(@"could not map destination file");
+    return nil;
+  }
+  return [[NSData alloc] initWithBytesNoCopy:bytes
+                                      length:(NSUInteger)st.st_size
+                                 deallocator:^(void* bytes, NSUInteger length) {
+                                   munmap(bytes, length);
+                                 }];
+}
+
+// Reads the whole stream into fd, then closes the stream
+static NSError* _Nullable drainStream(tanker_stream_t* stream, int fd)
+{
+  NSError* err = nil;
+  uint8_t* buffer = malloc(TKR_MAPPED_STREAM_READ_SIZE);
+  if (!buffer)
+    err = TKR_createNSErrorWithDomain(NSPOSIXErrorDomain, ENOMEM, @"could not allocate stream buffer");
+  while (!err)
+  {
+    void* ptr = waitFuture(tanker_stream_read(stream, buffer, TKR_MAPPED_STREAM_READ_SIZE), &err);
+    size_t const nbRead = (size_t)(intptr_t)ptr;
+    if (err || nbRead == 0)
+      break;
+    err = writeAll(fd, buffer, nbRead);
+  }
+  free(buffer);
+
+  NSError* closeErr = nil;
+  waitFuture(tanker_stream_close(stream), &closeErr);
+  return err ?: closeErr;
+}
+
+void TKR_streamDataToFile(NSData* _Nonnull data,
+                          NSURL* _Nonnull destination,
+                          TKRStreamFactory _Nonnull makeStream,
+                          dispatch_queue_t _Nonnull queue,
+                          void (^_Nonnull handler)(NSData* _Nullable, NSError* _Nullable))
+{
+  // the stream is drained on another thread, take the operation traced on this one now
+  __block NSData* result = nil;
+  __block NSError* error = nil;
+  void (^complete)(void) = ^{
+    handler(result, error);
+  };
+  if (TKR_traceEnabled())
+    complete = TKR_traceCompletion(complete);
+
+  NSString* path = destination.path;
+  TKRDataInput* input = [[TKRDataInput alloc] init];
+  input.data = data;
+  // the block below keeps input alive until the stream is closed
+  tanker_future_t* stream_fut = makeStream((tanker_stream_input_source_t)&readDataInput, (__bridge void*)input);
+
+  // reads are waited for, which must not happen on the caller's thread, it could be the completion queue
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    NSError* err = nil;
+    NSData* ret = nil;
+    tanker_stream_t* stream = waitFuture(stream_fut, &err);
+    if (!err)
+    {
+      int const fd = createProtectedFile(path, &err);
+      if (fd >= 0)
+      {
+        err = drainStream(stream, fd);
+        if (!err)
+          ret = mapFile(fd, &err);
+        close(fd);
+        // a partial output is useless, and could hold decrypted data
+        if (err)
+          unlink(path.fileSystemRepresentation);
+      }
+      else
+      {
+        // input must outlive the stream
+        NSError* closeErr = nil;
+        waitFuture(tanker_stream_close(stream), &closeErr);
+      }
+    }
+    (void)input;
+
+    result = ret;
+    error = err;
+    dispatch_async(queue, complete);
+  });
+}
@@ -1,5 +1,8 @@
 #include <Tanker/TKRNetwork.h>
 #include <Tanker/TKRTanker.h>
+#include <Tanker/TKRTankerOptions.h>
+#import <Tanker/TKRTankerOptions+Private.h>
+#import <Tanker/TKRTracer+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
 
 #include <libkern/OSAtomic.h>
@@ -61,61 +64,81 @@
         forHTTPHeaderField:[NSString stringWithUTF8String:hdr->name]];
   }
 
-  TKRTanker* tanker = (__bridge TKRTanker*)data;
-  [req setValue:tanker.options.sdkType forHTTPHeaderField:@"X-Tanker-SdkType"];
+  // data is retained until the native instance is destroyed, which may outlive the TKRTanker
+  TKRTankerOptions* options = (__bridge TKRTankerOptions*)data;
+  [req setValue:options.sdkType forHTTPHeaderField:@"X-Tanker-SdkType"];
   [req setValue:[TKRTanker versionString] forHTTPHeaderField:@"X-Tanker-SdkVersion"];
 
   NSNumber* requestId = [NSNumber numberWithInteger:OSAtomicIncrement32(&_lastId)];
 
+  TKRHTTPResponseHandler onResponse = ^(NSData* data, NSURLResponse* baseResponse, NSError* error) {
+    NSHTTPURLResponse* response = (NSHTTPURLResponse*)baseResponse;
+
+    tanker_http_response_t cresponse;
+
+    if (error)
+    {
+      cresponse.error_msg = error.localizedDescription.UTF8String;
+      cresponse.headers = NULL;
+      cresponse.num_headers = 0;
+      cresponse.body = NULL;
+      cresponse.body_size = 0;
+    }
+    else
+    {
+      cresponse.num_headers = (int32_t)response.allHeaderFields.count;
+      cresponse.headers = malloc(sizeof(tanker_http_header_t) * response.allHeaderFields.count);
+      int i = 0;
+      for (NSString* key in response.allHeaderFields)
+      {
+        cresponse.headers[i++] = (tanker_http_header_t){
+            .name = key.UTF8String,
+            .value = ((NSString*)response.allHeaderFields[key]).UTF8String,
+        };
+      }
+
+      cresponse.error_msg = NULL;
+      cresponse.status_code = (int32_t)response.statusCode;
+      cresponse.body = data.bytes;
+      cresponse.body_size = data.length;
+    }
+
+    @synchronized(self)
+    {
+      id task = [self->_requests objectForKey:requestId];
+      if (task)
+      {
+        tanker_http_handle_response(crequest, &cresponse);
+        [self->_requests removeObjectForKey:requestId];
+      }
+    }
+
+    free(cresponse.headers);
+  };
+  if (TKR_traceEnabled())
+  {
+    uint64_t const traceStart = TKR_traceNow();
+    TKRHTTPResponseHandler untraced = onResponse;
+    onResponse = ^(NSData* data, NSURLResponse* baseResponse, NSError* error) {
+      TKR_traceRecordSpan("http", 0, traceStart, TKR_traceNow());
+      untraced(data, baseResponse, error);
+    };
+  }
+
+  if (options.httpTransport)
+  {
+    // there is no task to cancel, removing the request is enough to drop its response
+    @synchronized(self)
+    {
+      [self->_requests setObject:[NSNull null] forKey:requestId];
+    }
+    [options.httpTransport sendRequest:req completionHandler:onResponse];
+    return (tanker_http_request_handle_t*)TKR_numberToPtr(requestId);
+  }
+
   NSURLSessionConfiguration* configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
   NSURLSession* session = [NSURLSession sessionWithConfiguration:configuration delegate:self delegateQueue:nil];
-
-  NSURLSessionDataTask* task =
-      [session dataTaskWithRequest:req
-                 completionHandler:^(NSData* data, NSURLResponse* baseResponse, NSError* error) {
-                   NSHTTPURLResponse* response = (NSHTTPURLResponse*)baseResponse;
-
-                   tanker_http_response_t cresponse;
-
-                   if (error)
-                   {
-                     cresponse.error_msg = error.localizedDescription.UTF8String;
-                     cresponse.headers = NULL;
-                     cresponse.num_headers = 0;
-                     cresponse.body = NULL;
-                     cresponse.body_size = 0;
-                   }
-                   else
-                   {
-                     cresponse.num_headers = (int32_t)response.allHeaderFields.count;
-                     cresponse.headers = malloc(sizeof(tanker_http_header_t) * response.allHeaderFields.count);
-                     int i = 0;
-                     for (NSString* key in response.allHeaderFields)
-                     {
-                       cresponse.headers[i++] = (tanker_http_header_t){
-                           .name = key.UTF8String,
-                           .value = ((NSString*)response.allHeaderFields[key]).UTF8String,
-                       };
-                     }
-
-                     cresponse.error_msg = NULL;
-                     cresponse.status_code = (int32_t)response.statusCode;
-                     cresponse.body = data.bytes;
-                     cresponse.body_size = data.length;
-                   }
-
-                   @synchronized(self)
-                   {
-                     NSURLSessionDataTask* task = [self->_requests objectForKey:requestId];
-                     if (task)
-                     {
-                       tanker_http_handle_response(crequest, &cresponse);
-                       [self->_requests removeObjectForKey:requestId];
-                     }
-                   }
-
-                   free(cresponse.headers);
-                 }];
+  NSURLSessionDataTask* task = [session dataTaskWithRequest:req completionHandler:onResponse];
 
   @synchronized(self)
   {
@@ -146,10 +169,11 @@
   NSNumber* requestId = TKR_ptrToNumber(request_handle);
   @synchronized(self)
   {
-    NSURLSessionDataTask* task = [self->_requests objectForKey:requestId];
+    id task = [self->_requests objectForKey:requestId];
     if (task)
     {
-      [task cancel];
+      if ([task isKindOfClass:[NSURLSessionTask class]])
+        [task cancel];
       [self->_requests removeObjectForKey:requestId];
     }
   }
@@ -0,0 +1,113 @@
+import Foundation
+
+// Size of the blocks fetched from a random-access source
+private let RangeSourceBlockSize = 1024 * 1024;
+
+// Where the encrypted data of a range decryption comes from
+@available(iOS 13.0, *)
+public enum EncryptedDataSource {
+  case file(URL)
+  // Called with an offset and a maximum length, returns the data at that offset, which is empty past the end
+  case blocks((_ offset: UInt64, _ maxLength: Int) async throws -> Data)
+}
+
+// Decrypts byte ranges of an encrypted stream, e.g. to seek in a media file.
+//
+// The chunks of the encrypted stream can only be decrypted in order, so reading a range decrypts the stream from the
+// start up to the end of the range. Decrypted bytes before the range are discarded instead of being kept, and the
+// stream is not read further than the range. The stream stays open between reads: reading a range after the previous
+// one continues from there, reading before it starts over.
+// It must not be used concurrently.
+@available(iOS 13.0, *)
+public final class SeekableDecryptionReader {
+  private let tanker: Tanker;
+  private let source: EncryptedDataSource;
+  private let readAhead: Int;
+
+  private var stream: ChunkStream?;
+  private var iterator: ChunkStream.AsyncIterator?;
+  // Decrypted offset of the start of chunk
+  private var position: UInt64 = 0;
+  private var chunk = Data();
+
+  public init(tanker: Tanker, source: EncryptedDataSource, readAhead: Int = 1) {
+    self.tanker = tanker;
+    self.source = source;
+    self.readAhead = readAhead;
+  }
+
+  private func makeInput() throws -> StreamInput {
+    switch source {
+    case .file(let url):
+      guard let stream = InputStream(url: url) else {
+        throw TKR_createNSError(UInt(Error.ioError.rawValue), "could not open \(url.path)") as NSError;
+      }
+      return makeStreamInput(stream, readAhead: readAhead);
+    case .blocks(let fetch):
+      var offset: UInt64 = 0;
+      return AsyncSequenceInput(readAhead: readAhead, nextChunk: {
+        let block = try await fetch(offset, RangeSourceBlockSize);
+        offset += UInt64(block.count);
+        return block.isEmpty ? nil : block;
+      });
+    }
+  }
+
+  private func restart() async throws {
+    iterator = nil;
+    stream = nil;
+    position = 0;
+    chunk = Data();
+    let stream = try await tanker.decryptStream(input: try makeInput(), readAhead: readAhead);
+    self.stream = stream;
+    self.iterator = stream.makeAsyncIterator();
+  }
+
+  // Returns the decrypted bytes of range, fewer if the stream ends before its end
+  public func read(range: Range<UInt64>) async throws -> Data {
+    if range.isEmpty {
+      return Data();
+    }
+    if iterator == nil || range.lowerBound < position {
+      try await restart();
+    }
+
+    var result = Data();
+    result.reserveCapacity(Int(range.count));
+    do {
+      while true {
+        if chunk.isEmpty {
+          guard let next = try await iterator!.next() else {
+            break;
+          }
+          chunk = next;
+        }
+        let chunkEnd = position + UInt64(chunk.count);
+        if chunkEnd > range.lowerBound {
+          let start = Int(max(range.lowerBound, position) - position);
+          let end = Int(min(range.upperBound, chunkEnd) - position);
+          result.append(chunk[(chunk.startIndex + start)..<(chunk.startIndex + end)]);
+        }
+        if chunkEnd >= range.upperBound {
+          // the rest of the chunk may be read by the next range
+          break;
+        }
+        position = chunkEnd;
+        chunk = Data();
+      }
+    } catch {
+      iterator = nil;
+      stream = nil;
+      throw error;
+    }
+    return result;
+  }
+}
+
+@available(iOS 13.0, *)
+public extension Tanker {
+  // Decrypts a byte range of an encrypted stream, see SeekableDecryptionReader
+  func decrypt(range: Range<UInt64>, from source: EncryptedDataSource) async throws -> Data {
+    return try await SeekableDecryptionReader(tanker: self, source: source).read(range: range);
+  }
+}
@@ -0,0 +1,142 @@
+#import <Tanker/TKRShareBatcher+Private.h>
+#import <Tanker/TKRSwift+Private.h>
+#import <Tanker/TKRTanker+Private.h>
+
+@interface TKRPendingShare : NSObject
+
+@property(nonnull) TKRSharingOptions* options;
+// Keeps the instance alive until the batch is sent
+@property(nonnull) TKRTanker* tanker;
+@property(nonnull) NSMutableOrderedSet<NSString*>* resourceIDs;
+@property(nonnull) NSMutableArray<NSArray<NSString*>*>* callerResourceIDs;
+@property(nonnull) NSMutableArray<TKRErrorHandler>* handlers;
+
+@end
+
+@implementation TKRPendingShare
+
+@end
+
+@interface TKRShareBatcher ()
+
+@property(nullable, weak) TKRTanker* tanker;
+@property NSTimeInterval interval;
+@property NSUInteger maxResources;
+@property(nonnull) NSMutableDictionary<NSArray*, TKRPendingShare*>* pending;
+@property(readwrite) NSUInteger nativeShareCount;
+
+@end
+
+@implementation TKRShareBatcher
+
++ (nonnull instancetype)batcherWithTanker:(nonnull TKRTanker*)tanker
+                                 interval:(NSTimeInterval)interval
+                             maxResources:(NSUInteger)maxResources
+{
+  TKRShareBatcher* batcher = [[TKRShareBatcher alloc] init];
+  batcher.tanker = tanker;
+  batcher.interval = interval;
+  batcher.maxResources = maxResources;
+  batcher.pending = [NSMutableDictionary dictionary];
+  return batcher;
+}
+
+static NSArray* normalizedKey(TKRSharingOptions* options)
+{
+  NSArray<NSString*>* users =
+      [[[NSSet setWithArray:options.shareWithUsers] allObjects] sortedArrayUsingSelector:@selector(compare:)];
+  NSArray<NSString*>* groups =
+      [[[NSSet setWithArray:options.shareWithGroups] allObjects] sortedArrayUsingSelector:@selector(compare:)];
+  return @[ users, groups ];
+}
+
+- (void)shareResourceIDs:(nonnull NSArray<NSString*>*)resourceIDs
+                 options:(nonnull TKRSharingOptions*)options
+       completionHandler:(nonnull TKRErrorHandler)handler
+{
+  NSArray* key = normalizedKey(options);
+  TKRPendingShare* flushNow = nil;
+  TKRPendingShare* created = nil;
+
+  @synchronized(self)
+  {
+    TKRPendingShare* pending = self.pending[key];
+    if (!pending)
+    {
+      pending = [[TKRPendingShare alloc] init];
+      // do not keep the caller's options, they could be modified later
+      pending.options = [[TKRSharingOptions alloc] init];
+      pending.options.shareWithUsers = key[0];
+      pending.options.shareWithGroups = key[1];
+      pending.tanker = self.tanker;
+      pending.resourceIDs = [NSMutableOrderedSet orderedSet];
+      pending.callerResourceIDs = [NSMutableArray array];
+      pending.handlers = [NSMutableArray array];
+      self.pending[key] = pending;
+      created = pending;
+    }
+    [pending.resourceIDs addObjectsFromArray:resourceIDs];
+    [pending.callerResourceIDs addObject:[resourceIDs copy]];
+    [pending.handlers addObject:handler];
+    if (pending.resourceIDs.count >= self.maxResources)
+    {
+      [self.pending removeObjectForKey:key];
+      flushNow = pending;
+    }
+  }
+
+  if (flushNow)
+  {
+    [self send:flushNow];
+    return;
+  }
+  if (!created)
+    return;
+
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.interval * NSEC_PER_SEC)),
+                 dispatch_get_global_queue(QOS_CLASS_UTILITY, 0),
+                 ^{
+                   @synchronized(self)
+                   {
+                     // already sent because it was full
+                     if (self.pending[key] != created)
+                       return;
+                     [self.pending removeObjectForKey:key];
+                   }
+                   [self send:created];
+                 });
+}
+
+- (void)countNativeShare
+{
+  @synchronized(self)
+  {
+    self.nativeShareCount += 1;
+  }
+}
+
+- (void)send:(nonnull TKRPendingShare*)batch
+{
+  [self countNativeShare];
+  [batch.tanker
+      shareResourceIDsImpl:batch.resourceIDs.array
+                   options:batch.options
+         completionHandler:^(NSError* err) {
+           if (!err || batch.handlers.count == 1)
+           {
+             for (TKRErrorHandler handler in batch.handlers)
+               handler(err);
+             return;
+           }
+           // the batch fails as a whole, share each caller's resources separately to give them their own error
+           for (NSUInteger i = 0; i < batch.handlers.count; ++i)
+           {
+             [self countNativeShare];
+             [batch.tanker shareResourceIDsImpl:batch.callerResourceIDs[i]
+                                        options:batch.options
+                              completionHandler:batch.handlers[i]];
+           }
+         }];
+}
+
+@end
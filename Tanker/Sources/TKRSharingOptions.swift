@@ -1,5 +1,7 @@
 @objc(TKRSharingOptions)
 public class SharingOptions: NSObject {
+  static let C_SHARING_OPTIONS_VERSION: UInt8 = 1;
+
   @objc
   public var shareWithUsers: Array<String>;
   @objc
@@ -10,4 +12,18 @@ public class SharingOptions: NSObject {
     self.shareWithUsers = [];
     self.shareWithGroups = [];
   }
+
+  func withCSharingOptions<R>(_ body: (UnsafePointer<tanker_sharing_options_t>) throws -> R) rethrows -> R {
+    return try withCStrings(self.shareWithUsers) { cUsers in
+      try withCStrings(self.shareWithGroups) { cGroups in
+        var cOptions = tanker_sharing_options_t();
+        cOptions.version = Self.C_SHARING_OPTIONS_VERSION;
+        cOptions.share_with_users = cUsers;
+        cOptions.nb_users = UInt32(self.shareWithUsers.count);
+        cOptions.share_with_groups = cGroups;
+        cOptions.nb_groups = UInt32(self.shareWithGroups.count);
+        return try body(&cOptions);
+      }
+    }
+  }
 }
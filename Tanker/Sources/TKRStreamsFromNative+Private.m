@@ -1,14 +1,23 @@
 #import <Foundation/Foundation.h>
 #import <Foundation/NSStream.h>
 #import <objc/runtime.h>
+#import <os/lock.h>
 
+#import <Tanker/TKRCancellationToken+Private.h>
 #import <Tanker/TKRError.h>
 #import <Tanker/TKRStreamsFromNative+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
 
 @interface TKRStreamsFromNative () <NSStreamDelegate>
 {
+  // cancel runs on the main queue while read:maxLength: runs on the consumer's thread, cstreamLock guards cstream,
+  // readInProgress, closeAfterRead and endHandler. A cancel during a read leaves the cancellation error and the close
+  // of the native stream to the read, once it returns, so that only one thread changes the stream status at a time.
+  os_unfair_lock cstreamLock;
   tanker_stream_t* _Nullable cstream;
+  BOOL readInProgress;
+  BOOL closeAfterRead;
+  dispatch_block_t _Nullable endHandler;
   TKRAsyncStreamReader* _Nonnull reader;
 
 @public
@@ -16,7 +25,7 @@
   tanker_future_t* bytes_available_fut;
 }
 
-- (void)triggerCTankerRead;
+- (void)triggerCTankerRead:(nonnull tanker_stream_t*)stream;
 
 @end
 
@@ -25,7 +34,7 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
   TKRStreamsFromNative* source = (__bridge_transfer TKRStreamsFromNative*)data;
 
   TKR_runOnMainQueue(^{
-    if ([source streamStatus] == NSStreamStatusAtEnd)
+    if ([source streamStatus] == NSStreamStatusAtEnd || [source streamStatus] == NSStreamStatusError)
       return;
     source->hasBytesAvailable = YES;
     [source enqueueEvent:NSStreamEventHasBytesAvailable];
@@ -33,6 +42,17 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
   return nil;
 }
 
+static void* releaseReaderFromNative(tanker_future_t* fut, void* data)
+{
+  TKRAsyncStreamReader* reader = (__bridge_transfer TKRAsyncStreamReader*)data;
+
+  // the native stream is closed, it will not read its input anymore
+  TKR_runOnMainQueue(^{
+    [reader releaseFromNative];
+  });
+  return nil;
+}
+
 @implementation TKRStreamsFromNative
 
 #pragma mark - TKRStreamsFromNative
@@ -48,6 +68,7 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
 {
   if (self = [super init])
   {
+    self->cstreamLock = OS_UNFAIR_LOCK_INIT;
     self->cstream = cstream;
     self->reader = reader;
     self->bytes_available_fut = nil;
@@ -57,16 +78,69 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
 
 - (void)dealloc
 {
+  [self callEndHandler];
   tanker_future_destroy(self->bytes_available_fut);
 }
 
-- (void)triggerCTankerRead
+- (void)setEndHandler:(nonnull dispatch_block_t)handler
+{
+  os_unfair_lock_lock(&self->cstreamLock);
+  self->endHandler = handler;
+  os_unfair_lock_unlock(&self->cstreamLock);
+}
+
+- (void)callEndHandler
+{
+  os_unfair_lock_lock(&self->cstreamLock);
+  dispatch_block_t handler = self->endHandler;
+  self->endHandler = nil;
+  os_unfair_lock_unlock(&self->cstreamLock);
+  if (handler)
+    handler();
+}
+
+- (void)cancel
+{
+  [self->reader cancel];
+  os_unfair_lock_lock(&self->cstreamLock);
+  tanker_stream_t* stream = self->cstream;
+  if (!stream || self->closeAfterRead)
+  {
+    os_unfair_lock_unlock(&self->cstreamLock);
+    return;
+  }
+  // read:maxLength: fails the stream and closes the native stream when it is done with it
+  BOOL const closeNow = !self->readInProgress;
+  if (closeNow)
+  {
+    [self setError:TKR_createCanceledError()];
+    self->cstream = nil;
+  }
+  else
+    self->closeAfterRead = YES;
+  os_unfair_lock_unlock(&self->cstreamLock);
+
+  if (closeNow)
+    [self closeCancelledCStream:stream];
+}
+
+- (void)closeCancelledCStream:(nonnull tanker_stream_t*)stream
+{
+  tanker_future_t* close_fut = tanker_stream_close(stream);
+  tanker_future_t* release_fut =
+      tanker_future_then(close_fut, &releaseReaderFromNative, (__bridge_retained void*)self->reader);
+  tanker_future_destroy(close_fut);
+  tanker_future_destroy(release_fut);
+  [self callEndHandler];
+}
+
+- (void)triggerCTankerRead:(nonnull tanker_stream_t*)stream
 {
   // reading 0 will either:
   // - return immediately 0
   // - read the next chunk of input, and return 0
   // this is needed to be signaled when bytes are available
-  tanker_future_t* read_fut = tanker_stream_read(self->cstream, nil, 0);
+  tanker_future_t* read_fut = tanker_stream_read(stream, nil, 0);
   tanker_future_destroy(self->bytes_available_fut);
   self->bytes_available_fut = tanker_future_then(read_fut, &finishTankerRead, (__bridge_retained void*)self);
   tanker_future_destroy(read_fut);
@@ -96,11 +170,58 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
   // this future is always ready when read is called due to hasBytesAvailable being set to YES.
   // when run synchronously, the thread is blocked until bytes are available
   tanker_future_wait(self->bytes_available_fut);
-  tanker_future_t* read_future = tanker_stream_read(self->cstream, buffer, (int64_t)maxLength);
+  os_unfair_lock_lock(&self->cstreamLock);
+  tanker_stream_t* stream = self->cstream;
+  self->readInProgress = stream != nil;
+  os_unfair_lock_unlock(&self->cstreamLock);
+  if (!stream)
+  {
+    // cancelled, the stream has the cancellation error
+    return -1;
+  }
+
+  NSInteger const nbRead = [self readCStream:stream buffer:buffer maxLength:maxLength];
+
+  // the native stream is closed once the read is over, when the stream is cancelled or at its end
+  os_unfair_lock_lock(&self->cstreamLock);
+  self->readInProgress = NO;
+  BOOL const cancelled = self->closeAfterRead;
+  if (cancelled || nbRead == 0)
+    self->cstream = nil;
+  os_unfair_lock_unlock(&self->cstreamLock);
+  if (cancelled)
+  {
+    [self setError:TKR_createCanceledError()];
+    [self closeCancelledCStream:stream];
+    return -1;
+  }
+  if (nbRead == 0)
+  {
+    tanker_future_destroy(tanker_stream_close(stream));
+    [self setStatus:NSStreamStatusAtEnd];
+    [self enqueueEvent:NSStreamEventEndEncountered];
+  }
+  if (nbRead <= 0)
+    [self callEndHandler];
+  return nbRead;
+}
+
+- (NSInteger)readCStream:(nonnull tanker_stream_t*)stream
+                  buffer:(nonnull uint8_t*)buffer
+               maxLength:(NSUInteger)maxLength
+{
+  tanker_future_t* read_future = tanker_stream_read(stream, buffer, (int64_t)maxLength);
   tanker_future_wait(read_future);
+  if (self->reader.cancelled)
+  {
+    // cancelled during the read, the stream has the cancellation error
+    tanker_future_destroy(read_future);
+    return -1;
+  }
   NSError* err = TKR_getOptionalFutureError(read_future);
   if (err)
   {
+    tanker_future_destroy(read_future);
     // Was it caused by the underlying input stream? If so, just keep the original error
     if (self->reader.stream.streamError)
       [self setError:self->reader.stream.streamError];
@@ -113,15 +234,8 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
   tanker_future_destroy(read_future);
   NSInteger nbRead = (NSInteger)(intptr_t)ptr;
   self->hasBytesAvailable = NO;
-  if (nbRead == 0)
-  {
-    tanker_future_destroy(tanker_stream_close(self->cstream));
-    self->cstream = nil;
-    [self setStatus:NSStreamStatusAtEnd];
-    [self enqueueEvent:NSStreamEventEndEncountered];
-  }
-  else
-    [self triggerCTankerRead];
+  if (nbRead != 0)
+    [self triggerCTankerRead:stream];
   return nbRead;
 }
 
@@ -147,7 +261,7 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
   [super open];
 
   self->hasBytesAvailable = NO;
-  [self triggerCTankerRead];
+  [self triggerCTankerRead:self->cstream];
 }
 
 - (void)close
@@ -155,6 +269,7 @@ static void* finishTankerRead(tanker_future_t* fut, void* data)
   if (![self isOpen])
     return;
   [super close];
+  [self callEndHandler];
 }
 
 @end
@@ -0,0 +1,129 @@
+import Foundation
+
+// Keys of the associated objects of TKREncryptionSession (must match the objc selectors)
+private let AssociatedCSessionKey = unsafeBitCast(sel_registerName("cSession"), to: UnsafeRawPointer.self)
+private let AssociatedCompletionQueueKey = unsafeBitCast(sel_registerName("completionQueue"), to: UnsafeRawPointer.self)
+
+// These methods resume the awaiting task directly from the native callback, they do not go through the
+// completion queue. Cancelling the task makes them throw CancellationError, but the native operation still
+// runs to completion and its result is discarded.
+@available(iOS 13.0, *)
+public extension Tanker {
+  func encrypt(_ clearData: Data, options: EncryptionOptions = EncryptionOptions()) async throws -> Data {
+    let clear = clearData as NSData;
+    let encryptedSize = tanker_encrypted_size(UInt64(clear.length), options.paddingStep.nativeValue.uint32Value);
+    let encrypted = try NativeBuffer(size: encryptedSize);
+
+    let encryptFuture = options.withCEncryptOptions { cOptionsPtr in
+      tanker_encrypt(self.cTanker, encrypted.pointer, clear.bytes.assumingMemoryBound(to: UInt8.self),
+                     UInt64(clear.length), cOptionsPtr)!
+    }
+    _ = try await awaitFuture(encryptFuture, keepAlive: [clear, encrypted]);
+    return encrypted.toData(count: Int(encryptedSize));
+  }
+
+  func encrypt(_ clearText: String, options: EncryptionOptions = EncryptionOptions()) async throws -> Data {
+    return try await self.encrypt(Data(clearText.utf8), options: options);
+  }
+
+  func decrypt(_ encryptedData: Data) async throws -> Data {
+    let encrypted = encryptedData as NSData;
+    let encryptedBytes = encrypted.bytes.assumingMemoryBound(to: UInt8.self);
+    let sizePtr = try unwrapAndFreeExpected(tanker_decrypted_size(encryptedBytes, UInt64(encrypted.length))!);
+    let decrypted = try NativeBuffer(size: UInt64(UInt(bitPattern: sizePtr)));
+
+    let decryptFuture = tanker_decrypt(self.cTanker, decrypted.pointer, encryptedBytes, UInt64(encrypted.length))!;
+    let clearSize = try await awaitFuture(decryptFuture, keepAlive: [encrypted, decrypted]);
+    return decrypted.toData(count: Int(UInt(bitPattern: clearSize)));
+  }
+
+  func decryptString(_ encryptedData: Data) async throws -> String {
+    guard let clearText = String(data: try await self.decrypt(encryptedData), encoding: .utf8) else {
+      throw TKR_createDecodingError() as NSError;
+    }
+    return clearText;
+  }
+
+  func share(_ resourceIDs: [String], options: SharingOptions) async throws {
+    if self.options.shareCoalescingInterval > 0 {
+      // go through the batcher so that async and completion handler shares are merged together
+      return try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Swift.Error>) in
+        self.shareResourceIDs(resourceIDs, options: options) { error in
+          if let error = error {
+            continuation.resume(throwing: error);
+          } else {
+            continuation.resume();
+          }
+        }
+      }
+    }
+    let shareFuture = withCStrings(resourceIDs) { cResourceIDs in
+      options.withCSharingOptions { cOptionsPtr in
+        tanker_share(self.cTanker, cResourceIDs, UInt64(resourceIDs.count), cOptionsPtr)!
+      }
+    }
+    _ = try await awaitFuture(shareFuture);
+  }
+
+  func createGroup(identities: [String]) async throws -> String {
+    let createFuture = withCStrings(identities) { cIdentities in
+      tanker_create_group(self.cTanker, cIdentities, UInt64(identities.count))!
+    }
+    let groupIDPtr = try await awaitFuture(createFuture, discardResult: { tanker_free_buffer($0) })!;
+    let groupID = String(cString: groupIDPtr.assumingMemoryBound(to: CChar.self));
+    tanker_free_buffer(groupIDPtr);
+    return groupID;
+  }
+
+  func updateGroupMembers(_ groupID: String, usersToAdd: [String], usersToRemove: [String] = []) async throws {
+    let updateFuture = withCStrings(usersToAdd) { cUsersToAdd in
+      withCStrings(usersToRemove) { cUsersToRemove in
+        tanker_update_group_members(self.cTanker, groupID.cString(using: .utf8),
+                                    cUsersToAdd, UInt64(usersToAdd.count),
+                                    cUsersToRemove, UInt64(usersToRemove.count))!
+      }
+    }
+    _ = try await awaitFuture(updateFuture);
+  }
+
+  // No default value for options, createEncryptionSession() is already imported from the completion handler API
+  func createEncryptionSession(options: EncryptionOptions) async throws -> EncryptionSession {
+    let openFuture = options.withCEncryptOptions { cOptionsPtr in
+      tanker_encryption_session_open(self.cTanker, cOptionsPtr)!
+    }
+    let cSession = try await awaitFuture(openFuture, discardResult: { cSession in
+      tanker_future_destroy(tanker_encryption_session_close(OpaquePointer(cSession)));
+    })!;
+    let session = EncryptionSession();
+    objc_setAssociatedObject(session, AssociatedCSessionKey, TKR_ptrToNumber(cSession), .OBJC_ASSOCIATION_RETAIN);
+    objc_setAssociatedObject(session, AssociatedCompletionQueueKey, self.options.completionQueue ?? DispatchQueue.main,
+                             .OBJC_ASSOCIATION_RETAIN);
+    return session;
+  }
+}
+
+@available(iOS 13.0, *)
+public extension EncryptionSession {
+  internal var cSession: OpaquePointer {
+    get {
+      return OpaquePointer(TKR_numberToPtr(objc_getAssociatedObject(self, AssociatedCSessionKey) as! NSNumber));
+    }
+  }
+
+  func encrypt(_ clearData: Data) async throws -> Data {
+    let clear = clearData as NSData;
+    let encryptedSize = tanker_encryption_session_encrypted_size(self.cSession, UInt64(clear.length));
+    let encrypted = try NativeBuffer(size: encryptedSize);
+
+    let encryptFuture = tanker_encryption_session_encrypt(self.cSession, encrypted.pointer,
+                                                          clear.bytes.assumingMemoryBound(to: UInt8.self),
+                                                          UInt64(clear.length))!;
+    // the session must not be closed while the operation runs
+    _ = try await awaitFuture(encryptFuture, keepAlive: [clear, encrypted, self]);
+    return encrypted.toData(count: Int(encryptedSize));
+  }
+
+  func encrypt(_ clearText: String) async throws -> Data {
+    return try await self.encrypt(Data(clearText.utf8));
+  }
+}
@@ -2,9 +2,11 @@
 #import <Foundation/Foundation.h>
 
 #import <Tanker/TKRError.h>
+#import <Tanker/TKRMappedDataStream+Private.h>
 #import <Tanker/TKRStreamsFromNative+Private.h>
 #import <Tanker/TKRSwift+Private.h>
 #import <Tanker/TKRTanker+Private.h>
+#import <Tanker/TKRTracer+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
 
 #include <Tanker/ctanker.h>
@@ -16,6 +18,16 @@ static void releaseCPointer(void* ptr)
   (void)((__bridge_transfer id)ptr);
 }
 
+dispatch_queue_t _Nonnull TKR_lifecycleQueue(void)
+{
+  static dispatch_queue_t queue;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    queue = dispatch_queue_create("io.tanker.lifecycle", DISPATCH_QUEUE_SERIAL);
+  });
+  return queue;
+}
+
 NSError* _Nullable convertEncryptionOptions(TKREncryptionOptions* _Nonnull opts, void* _Nonnull c_opts_ptr)
 {
   NSError* err = nil;
@@ -60,21 +72,56 @@ NSError* _Nullable convertSharingOptions(TKRSharingOptions* _Nonnull opts, void*
 
 void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
                            tanker_future_t* _Nonnull streamFut,
+                           TKRCancellationToken* _Nullable token,
+                           dispatch_queue_t _Nonnull queue,
                            TKRInputStreamHandler _Nonnull handler)
 {
+  // Until the stream is created, stop feeding the native side so that it fails early
+  id readerRegistration = [token addCancellationHandler:^{
+    TKR_runOnMainQueue(^{
+      [reader cancel];
+    });
+  }];
+
   TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
+    if (token)
+      [token removeCancellationHandler:readerRegistration];
     if (err)
     {
-      handler(nil, err);
+      // there is no native stream to release the reader when it closes
+      TKR_runOnMainQueue(^{
+        [reader releaseFromNative];
+      });
+      handler(nil, token.isCancelled ? TKR_createCanceledError() : err);
       return;
     }
     tanker_stream_t* stream = TKR_numberToPtr(ptrValue);
-    TKRStreamsFromNative* encryptionStream = [[TKRStreamsFromNative alloc] initWithCStream:stream asyncReader:reader];
-    handler(encryptionStream, nil);
+    TKRStreamsFromNative* nativeStream = [[TKRStreamsFromNative alloc] initWithCStream:stream asyncReader:reader];
+    if (token.isCancelled)
+    {
+      TKR_runOnMainQueue(^{
+        [nativeStream cancel];
+      });
+      handler(nil, TKR_createCanceledError());
+      return;
+    }
+    if (token)
+    {
+      __weak TKRStreamsFromNative* weakStream = nativeStream;
+      id streamRegistration = [token addCancellationHandler:^{
+        TKR_runOnMainQueue(^{
+          [weakStream cancel];
+        });
+      }];
+      [nativeStream setEndHandler:^{
+        [token removeCancellationHandler:streamRegistration];
+      }];
+    }
+    handler(nativeStream, nil);
   };
 
   tanker_future_t* resolve_fut =
-      tanker_future_then(streamFut, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+      tanker_future_then(streamFut, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, queue));
   tanker_future_destroy(resolve_fut);
 }
 
@@ -89,6 +136,7 @@ void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
 
   if (!encrypted_buffer)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, TKR_createNSErrorWithDomain(NSPOSIXErrorDomain, ENOMEM, @"could not allocate encrypted buffer"));
     return;
   }
@@ -120,6 +168,7 @@ void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
   NSError* err = convertEncryptionOptions(options, &encryption_options);
   if (err)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, err);
     return;
   }
@@ -128,8 +177,8 @@ void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
                                                    (uint8_t const*)clearData.bytes,
                                                    clearData.length,
                                                    &encryption_options);
-  tanker_future_t* resolve_future =
-      tanker_future_then(encrypt_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      encrypt_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(encrypt_future);
   tanker_future_destroy(resolve_future);
   TKR_freeCStringArray((char**)encryption_options.share_with_users, encryption_options.nb_users);
@@ -168,6 +217,7 @@ void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
   decrypted_size = (uint64_t)TKR_unwrapAndFreeExpected(expected_decrypted_size, &err);
   if (err)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, err);
     return;
   }
@@ -175,14 +225,15 @@ void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
   decrypted_buffer = (uint8_t*)malloc((unsigned long)decrypted_size);
   if (!decrypted_buffer)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, TKR_createNSErrorWithDomain(NSPOSIXErrorDomain, ENOMEM, @"could not allocate decrypted buffer"));
     return;
   }
   tanker_future_t* decrypt_future =
       tanker_decrypt((tanker_t*)self.cTanker, decrypted_buffer, encrypted_buffer, encrypted_size);
   // ensures encryptedData lives while the promise does by telling ARC to retain it
-  tanker_future_t* resolve_future =
-      tanker_future_then(decrypt_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      decrypt_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(decrypt_future);
   tanker_future_destroy(resolve_future);
   // Force encryptedData to be retained until the tanker_future is done
@@ -190,4 +241,45 @@ void completeStreamEncrypt(TKRAsyncStreamReader* _Nonnull reader,
   TKRAntiARCRetain(encryptedData);
 }
 
+- (void)encryptDataImpl:(nonnull NSData*)clearData
+            toFileAtURL:(nonnull NSURL*)destination
+                options:(nonnull TKREncryptionOptions*)options
+      completionHandler:(nonnull TKREncryptedDataHandler)handler
+{
+  tanker_encrypt_options_t encryption_options = TANKER_ENCRYPT_OPTIONS_INIT;
+  NSError* err = convertEncryptionOptions(options, &encryption_options);
+  if (err)
+  {
+    TKR_TRACE_CLEAR_OPERATION();
+    handler(nil, err);
+    return;
+  }
+  tanker_t* tanker = (tanker_t*)self.cTanker;
+  TKR_streamDataToFile(
+      clearData,
+      destination,
+      ^(tanker_stream_input_source_t source, void* sourceData) {
+        return tanker_stream_encrypt(tanker, source, sourceData, &encryption_options);
+      },
+      self.completionQueue,
+      handler);
+  TKR_freeCStringArray((char**)encryption_options.share_with_users, encryption_options.nb_users);
+  TKR_freeCStringArray((char**)encryption_options.share_with_groups, encryption_options.nb_groups);
+}
+
+- (void)decryptDataImpl:(nonnull NSData*)encryptedData
+            toFileAtURL:(nonnull NSURL*)destination
+      completionHandler:(nonnull TKRDecryptedDataHandler)handler
+{
+  tanker_t* tanker = (tanker_t*)self.cTanker;
+  TKR_streamDataToFile(
+      encryptedData,
+      destination,
+      ^(tanker_stream_input_source_t source, void* sourceData) {
+        return tanker_stream_decrypt(tanker, source, sourceData);
+      },
+      self.completionQueue,
+      handler);
+}
+
 @end
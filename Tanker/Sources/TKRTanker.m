@@ -3,14 +3,19 @@
 #import <Tanker/Storage/TKRDatastoreBindings.h>
 #import <Tanker/TKRAsyncStreamReader+Private.h>
 #import <Tanker/TKRAttachResult+Private.h>
+#import <Tanker/TKRBatch+Private.h>
+#import <Tanker/TKRBulkGroupUpdate+Private.h>
 #import <Tanker/TKREncryptionSession+Private.h>
 #import <Tanker/TKRError.h>
 #import <Tanker/TKRLogEntry.h>
+#import <Tanker/TKRLogQueue+Private.h>
+#import <Tanker/TKRMappedDataStream+Private.h>
 #import <Tanker/TKRNetwork.h>
 #import <Tanker/TKRStreamsFromNative+Private.h>
 #import <Tanker/TKRSwift+Private.h>
 #import <Tanker/TKRTanker+Private.h>
 #import <Tanker/TKRTankerOptions.h>
+#import <Tanker/TKRTracer+Private.h>
 #import <Tanker/TKRVerificationKey+Private.h>
 #import <Tanker/TKRVerificationMethod+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
@@ -23,23 +28,6 @@
 
 NSString* const TKRErrorDomain = @"TKRErrorDomain";
 
-TKRLogHandler globalLogHandler = ^(TKRLogEntry* _Nonnull entry) {
-  switch (entry.level)
-  {
-  case TKRLogLevelDebug:
-    break;
-  case TKRLogLevelInfo:
-    break;
-  case TKRLogLevelWarning:
-    break;
-  case TKRLogLevelError:
-    NSLog(@"Tanker Error: [%@] %@", entry.category, entry.message);
-    break;
-  default:
-    NSLog(@"Unknown Tanker log level: %c: [%@] %@", (int)entry.level, entry.category, entry.message);
-  }
-};
-
 static TKRVerificationMethod* _Nonnull cVerificationMethodToVerificationMethod(
     tanker_verification_method_t* c_verification)
 {
@@ -89,15 +77,10 @@ static void dispatchInBackground(id block)
   dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), block);
 }
 
-static void defaultLogHandler(tanker_log_record_t const* record)
+// Runs on the native threads, the record is queued and handled on the log queue
+static void logHandler(tanker_log_record_t const* record)
 {
-  TKRLogEntry* entry = [[TKRLogEntry alloc] init];
-  entry.category = [NSString stringWithCString:record->category encoding:NSUTF8StringEncoding];
-  entry.file = [NSString stringWithCString:record->file encoding:NSUTF8StringEncoding];
-  entry.message = [NSString stringWithCString:record->message encoding:NSUTF8StringEncoding];
-  entry.level = (TKRLogLevel)record->level;
-  entry.line = record->line;
-  globalLogHandler(entry);
+  TKR_logQueuePush(record);
 }
 
 static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cOptions)
@@ -114,29 +97,39 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 
 // Redeclare them as readwrite to set them.
 @property(nonnull, readwrite) TKRTankerOptions* options;
+@property(nullable, readwrite) TKRShareBatcher* shareBatcher;
+// Cache directory the datastore settings were registered with, unregistered once the native instance is destroyed
+@property(nullable) NSString* datastoreSettingsDir;
 
 @end
 
 @implementation TKRTanker
 
 @synthesize options = _options;
+@synthesize shareBatcher = _shareBatcher;
+@synthesize runningGroupUpdates = _runningGroupUpdates;
+// Implemented on the Swift side
+@dynamic verificationMethodsChangeHandler;
+
+- (nonnull instancetype)init
+{
+  if (self = [super init])
+    _runningGroupUpdates = [NSMutableDictionary dictionary];
+  return self;
+}
 
 // MARK: Class methods
 
-// Note: this constructor blocks until tanker_create resolves.
-// If we start doing background operation in tanker_create, we should
-// get rid of the tanker_future_wait()
-+ (nullable TKRTanker*)tankerWithOptions:(nonnull TKRTankerOptions*)options error:(NSError**)errResult
+// http_data must be the options, retained until the native instance is destroyed
+static tanker_future_t* createNativeTanker(TKRTankerOptions* options, void* http_data)
 {
-  __block TKRTanker* tanker = [[[self class] alloc] init];
-  tanker_set_log_handler(&defaultLogHandler);
-  tanker.options = options;
+  tanker_set_log_handler(&logHandler);
 
   tanker_options_t cOptions = TANKER_OPTIONS_INIT;
   convertOptions(options, &cOptions);
   cOptions.http_options.send_request = httpSendRequestCallback;
   cOptions.http_options.cancel_request = httpCancelRequestCallback;
-  cOptions.http_options.data = (__bridge void*)tanker;
+  cOptions.http_options.data = http_data;
   cOptions.datastore_options.open = TKR_datastore_open;
   cOptions.datastore_options.close = TKR_datastore_close;
   cOptions.datastore_options.nuke = TKR_datastore_nuke;
@@ -145,16 +138,62 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   cOptions.datastore_options.put_cache_values = TKR_datastore_put_cache_values;
   cOptions.datastore_options.find_cache_values = TKR_datastore_find_cache_values;
 
-  tanker_future_t* create_future = tanker_create(&cOptions);
+  return tanker_create(&cOptions);
+}
+
+static NSError* creationError(NSError* error)
+{
+  return TKR_createNSError(TKRErrorInvalidArgument,
+                           [NSString stringWithFormat:@"Could not init Tanker %@", [error localizedDescription]]);
+}
+
+// Must be balanced by unregisterDatastoreSettings once the native instance is destroyed
+static NSError* _Nullable registerDatastoreSettings(TKRTanker* tanker)
+{
+  TKRTankerOptions* options = tanker.options;
+  NSString* cacheDir = [options.cachePath copy];
+  if (!TKR_datastore_register_settings([cacheDir cStringUsingEncoding:NSUTF8StringEncoding],
+                                       options.datastoreWriteBehindDelay))
+    return TKR_createNSError(TKRErrorInvalidArgument,
+                             @"another Tanker instance uses this cachePath with a different datastoreWriteBehindDelay");
+  tanker.datastoreSettingsDir = cacheDir;
+  return nil;
+}
+
+static void unregisterDatastoreSettings(NSString* _Nullable cacheDir)
+{
+  TKR_datastore_unregister_settings([cacheDir cStringUsingEncoding:NSUTF8StringEncoding]);
+}
+
+// Note: this constructor blocks until tanker_create resolves.
+// tankerWithOptions:completionHandler: does not.
++ (nullable TKRTanker*)tankerWithOptions:(nonnull TKRTankerOptions*)options error:(NSError**)errResult
+{
+  // pending destructions may still hold the databases
+  dispatch_sync(TKR_lifecycleQueue(), ^{
+  });
+
+  TKRTanker* tanker = [[[self class] alloc] init];
+  tanker.options = options;
+  NSError* error = registerDatastoreSettings(tanker);
+  if (error)
+  {
+    if (errResult != nil)
+      *errResult = creationError(error);
+    return nil;
+  }
+
+  void* http_data = (__bridge_retained void*)options;
+  tanker_future_t* create_future = createNativeTanker(options, http_data);
   tanker_future_wait(create_future);
-  NSError* error = TKR_getOptionalFutureError(create_future);
+  error = TKR_getOptionalFutureError(create_future);
   if (error)
   {
     tanker_future_destroy(create_future);
+    (void)(__bridge_transfer TKRTankerOptions*)http_data;
+    unregisterDatastoreSettings(tanker.datastoreSettingsDir);
     if (errResult != nil)
-      *errResult =
-          TKR_createNSError(TKRErrorInvalidArgument,
-                            [NSString stringWithFormat:@"Could not init Tanker %@", [error localizedDescription]]);
+      *errResult = creationError(error);
     return nil;
   }
   tanker.cTanker = tanker_future_get_voidptr(create_future);
@@ -162,15 +201,62 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   return tanker;
 }
 
++ (void)tankerWithOptions:(nonnull TKRTankerOptions*)options completionHandler:(nonnull TKRTankerHandler)handler
+{
+  TKRTanker* tanker = [[[self class] alloc] init];
+  tanker.options = options;
+  NSError* error = registerDatastoreSettings(tanker);
+  if (error)
+  {
+    TKR_runOnQueue(tanker.completionQueue, ^{
+      handler(nil, creationError(error));
+    });
+    return;
+  }
+
+  // queued after pending destructions, which may still hold the databases
+  dispatch_async(TKR_lifecycleQueue(), ^{
+    void* http_data = (__bridge_retained void*)options;
+    TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
+      if (err)
+      {
+        (void)(__bridge_transfer TKRTankerOptions*)http_data;
+        unregisterDatastoreSettings(tanker.datastoreSettingsDir);
+        handler(nil, creationError(err));
+        return;
+      }
+      tanker.cTanker = TKR_numberToPtr(ptrValue);
+      handler(tanker, nil);
+    };
+
+    tanker_future_t* create_future = createNativeTanker(options, http_data);
+    tanker_future_t* resolve_future = tanker_future_then(
+        create_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, tanker.completionQueue));
+    tanker_future_destroy(create_future);
+    tanker_future_destroy(resolve_future);
+  });
+}
+
 + (void)connectLogHandler:(nonnull TKRLogHandler)handler
 {
-  globalLogHandler = handler;
+  TKR_logQueueSetHandler(handler);
+}
+
++ (void)setMinimumLogLevel:(TKRLogLevel)level
+{
+  TKR_logQueueSetMinimumLevel(level);
+}
+
++ (uint64_t)droppedLogCount
+{
+  return TKR_logQueueDroppedCount();
 }
 
 // MARK: Instance methods
 
 - (void)verificationMethodsWithCompletionHandler:(nonnull TKRVerificationMethodsHandler)handler
 {
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
     if (err)
       handler(nil, err);
@@ -187,8 +273,8 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   };
 
   tanker_future_t* methods_future = tanker_get_verification_methods((tanker_t*)self.cTanker);
-  tanker_future_t* resolve_future =
-      tanker_future_then(methods_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      methods_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(methods_future);
   tanker_future_destroy(resolve_future);
 }
@@ -196,6 +282,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 - (void)attachProvisionalIdentity:(nonnull NSString*)provisionalIdentity
                 completionHandler:(nonnull TKRAttachResultHandler)handler
 {
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
     if (err)
       handler(nil, err);
@@ -217,14 +304,15 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   char const* c_provisional_identity = [provisionalIdentity cStringUsingEncoding:NSUTF8StringEncoding];
 
   tanker_future_t* attach_future = tanker_attach_provisional_identity((tanker_t*)self.cTanker, c_provisional_identity);
-  tanker_future_t* resolve_future =
-      tanker_future_then(attach_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      attach_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(attach_future);
   tanker_future_destroy(resolve_future);
 }
 
 - (void)createOidcNonceWithCompletionHandler:(nonnull TKRNonceHandler)handler
 {
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
     if (err)
     {
@@ -238,14 +326,15 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   };
 
   tanker_future_t* nonce_future = tanker_create_oidc_nonce((tanker_t*)self.cTanker);
-  tanker_future_t* resolve_future =
-      tanker_future_then(nonce_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      nonce_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(nonce_future);
   tanker_future_destroy(resolve_future);
 }
 
 - (void)setOidcTestNonce:(nonnull NSString*)nonce completionHandler:(nonnull TKRErrorHandler)handler
 {
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* unused, NSError* err) {
     handler(err);
   };
@@ -253,8 +342,8 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   char const* c_nonce = [nonce cStringUsingEncoding:NSUTF8StringEncoding];
 
   tanker_future_t* fut = tanker_set_oidc_test_nonce((tanker_t*)self.cTanker, c_nonce);
-  tanker_future_t* resolve_future =
-      tanker_future_then(fut, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      fut, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(fut);
   tanker_future_destroy(resolve_future);
 }
@@ -272,7 +361,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   NSData* data = TKR_convertStringToData(clearText, &err);
 
   if (err)
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(nil, err);
     });
   else
@@ -282,6 +371,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 - (void)decryptStringFromData:(nonnull NSData*)encryptedData
             completionHandler:(nonnull TKRDecryptedStringHandler)handler
 {
+  TKR_TRACE_OPERATION();
   id adapter = ^(TKRPtrAndSizePair* hack, NSError* err) {
     if (err)
     {
@@ -294,6 +384,13 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
                                                    length:hack.ptrSize
                                                  encoding:NSUTF8StringEncoding
                                              freeWhenDone:YES];
+    if (!ret)
+    {
+      // not freed when the string cannot be created
+      free(decrypted_buffer);
+      handler(nil, TKR_createDecodingError());
+      return;
+    }
     handler(ret, nil);
   };
 
@@ -309,6 +406,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
               options:(nonnull TKREncryptionOptions*)options
     completionHandler:(nonnull TKREncryptedDataHandler)handler
 {
+  TKR_TRACE_OPERATION();
   id adapter = ^(TKRPtrAndSizePair* hack, NSError* err) {
     if (err)
     {
@@ -325,6 +423,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 
 - (void)decryptData:(nonnull NSData*)encryptedData completionHandler:(nonnull TKRDecryptedDataHandler)handler
 {
+  TKR_TRACE_OPERATION();
   id adapter = ^(TKRPtrAndSizePair* hack, NSError* err) {
     if (err)
     {
@@ -339,6 +438,170 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   [self decryptDataImpl:encryptedData completionHandler:adapter];
 }
 
+- (void)encryptData:(nonnull NSData*)clearData
+          toFileAtURL:(nonnull NSURL*)destination
+    completionHandler:(nonnull TKREncryptedDataHandler)handler
+{
+  [self encryptData:clearData
+            toFileAtURL:destination
+                options:[[TKREncryptionOptions alloc] init]
+      completionHandler:handler];
+}
+
+- (void)encryptData:(nonnull NSData*)clearData
+          toFileAtURL:(nonnull NSURL*)destination
+              options:(nonnull TKREncryptionOptions*)options
+    completionHandler:(nonnull TKREncryptedDataHandler)handler
+{
+  TKR_TRACE_OPERATION();
+  if (!destination.isFileURL)
+  {
+    TKR_TRACE_CLEAR_OPERATION();
+    handler(nil, TKR_createNSError(TKRErrorInvalidArgument, @"destination must be a file URL"));
+    return;
+  }
+  [self encryptDataImpl:clearData toFileAtURL:destination options:options completionHandler:handler];
+}
+
+- (void)decryptData:(nonnull NSData*)encryptedData
+          toFileAtURL:(nonnull NSURL*)destination
+    completionHandler:(nonnull TKRDecryptedDataHandler)handler
+{
+  TKR_TRACE_OPERATION();
+  if (!destination.isFileURL)
+  {
+    TKR_TRACE_CLEAR_OPERATION();
+    handler(nil, TKR_createNSError(TKRErrorInvalidArgument, @"destination must be a file URL"));
+    return;
+  }
+  [self decryptDataImpl:encryptedData toFileAtURL:destination completionHandler:handler];
+}
+
+- (void)encryptDataBatch:(nonnull NSArray<NSData*>*)clearData completionHandler:(nonnull TKRBatchDataHandler)handler
+{
+  [self encryptDataBatch:clearData options:[[TKREncryptionOptions alloc] init] completionHandler:handler];
+}
+
+- (void)encryptDataBatch:(nonnull NSArray<NSData*>*)clearData
+                 options:(nonnull TKREncryptionOptions*)options
+       completionHandler:(nonnull TKRBatchDataHandler)handler
+{
+  [self encryptDataBatch:clearData options:options cancellationToken:nil completionHandler:handler];
+}
+
+- (void)encryptDataBatch:(nonnull NSArray<NSData*>*)clearData
+                 options:(nonnull TKREncryptionOptions*)options
+       cancellationToken:(nullable TKRCancellationToken*)token
+       completionHandler:(nonnull TKRBatchDataHandler)handler
+{
+  if (clearData.count == 0)
+  {
+    TKR_runOnQueue(self.completionQueue, ^{
+      handler(@[]);
+    });
+    return;
+  }
+  TKRBatchContext* batch = [TKRBatchContext batchWithCount:clearData.count
+                                                     queue:self.completionQueue
+                                                   handler:handler];
+  [batch bindCancellationToken:token];
+
+  tanker_encrypt_options_t encryption_options = TANKER_ENCRYPT_OPTIONS_INIT;
+  NSError* err = convertEncryptionOptions(options, &encryption_options);
+  if (err)
+  {
+    for (NSUInteger i = 0; i < clearData.count; ++i)
+      [batch setError:err atIndex:i];
+    return;
+  }
+
+  tanker_t* ctanker = (tanker_t*)self.cTanker;
+  tanker_encrypt_options_t const* c_options = &encryption_options;
+  uint32_t padding_step = options.paddingStep.nativeValue.unsignedIntValue;
+  // Items are submitted concurrently, each native future stores its result in the batch without any main queue hop
+  dispatch_apply(clearData.count, DISPATCH_APPLY_AUTO, ^(size_t i) {
+    // the cancelled items already have their result
+    if (batch.isCancelled)
+      return;
+    NSData* data = clearData[i];
+    uint64_t encrypted_size = tanker_encrypted_size(data.length, padding_step);
+    uint8_t* encrypted_buffer = (uint8_t*)malloc((unsigned long)encrypted_size);
+    if (!encrypted_buffer)
+    {
+      [batch setError:TKR_createNSErrorWithDomain(NSPOSIXErrorDomain, ENOMEM, @"could not allocate encrypted buffer")
+              atIndex:i];
+      return;
+    }
+    TKRBatchItem* item = [TKRBatchItem itemWithBatch:batch
+                                               index:i
+                                               input:data
+                                              buffer:encrypted_buffer
+                                                size:encrypted_size];
+    tanker_future_t* encrypt_future =
+        tanker_encrypt(ctanker, encrypted_buffer, (uint8_t const*)data.bytes, data.length, c_options);
+    tanker_future_t* resolve_future = tanker_future_then(
+        encrypt_future, (tanker_future_then_t)&TKR_resolveBatchItem, (__bridge_retained void*)item);
+    tanker_future_destroy(encrypt_future);
+    tanker_future_destroy(resolve_future);
+  });
+  TKR_freeCStringArray((char**)encryption_options.share_with_users, encryption_options.nb_users);
+  TKR_freeCStringArray((char**)encryption_options.share_with_groups, encryption_options.nb_groups);
+}
+
+- (void)decryptDataBatch:(nonnull NSArray<NSData*>*)encryptedData
+       completionHandler:(nonnull TKRBatchDataHandler)handler
+{
+  [self decryptDataBatch:encryptedData cancellationToken:nil completionHandler:handler];
+}
+
+- (void)decryptDataBatch:(nonnull NSArray<NSData*>*)encryptedData
+       cancellationToken:(nullable TKRCancellationToken*)token
+       completionHandler:(nonnull TKRBatchDataHandler)handler
+{
+  if (encryptedData.count == 0)
+  {
+    TKR_runOnQueue(self.completionQueue, ^{
+      handler(@[]);
+    });
+    return;
+  }
+  TKRBatchContext* batch = [TKRBatchContext batchWithCount:encryptedData.count
+                                                     queue:self.completionQueue
+                                                   handler:handler];
+  [batch bindCancellationToken:token];
+
+  tanker_t* ctanker = (tanker_t*)self.cTanker;
+  dispatch_apply(encryptedData.count, DISPATCH_APPLY_AUTO, ^(size_t i) {
+    if (batch.isCancelled)
+      return;
+    NSData* data = encryptedData[i];
+    NSError* err = nil;
+    uint64_t decrypted_size = (uint64_t)TKR_unwrapAndFreeExpected(
+        tanker_decrypted_size((uint8_t const*)data.bytes, data.length), &err);
+    if (err)
+    {
+      [batch setError:err atIndex:i];
+      return;
+    }
+    // malloc(0) may return NULL, the buffer is never read in that case
+    uint8_t* decrypted_buffer = (uint8_t*)malloc((unsigned long)(decrypted_size ? decrypted_size : 1));
+    if (!decrypted_buffer)
+    {
+      [batch setError:TKR_createNSErrorWithDomain(NSPOSIXErrorDomain, ENOMEM, @"could not allocate decrypted buffer")
+              atIndex:i];
+      return;
+    }
+    // The decrypted size is only an upper bound, the exact size is given by the future
+    TKRBatchItem* item = [TKRBatchItem itemWithBatch:batch index:i input:data buffer:decrypted_buffer size:0];
+    tanker_future_t* decrypt_future =
+        tanker_decrypt(ctanker, decrypted_buffer, (uint8_t const*)data.bytes, data.length);
+    tanker_future_t* resolve_future = tanker_future_then(
+        decrypt_future, (tanker_future_then_t)&TKR_resolveBatchItem, (__bridge_retained void*)item);
+    tanker_future_destroy(decrypt_future);
+    tanker_future_destroy(resolve_future);
+  });
+}
+
 - (nullable NSString*)resourceIDOfEncryptedData:(nonnull NSData*)encryptedData error:(NSError* _Nullable* _Nonnull)error
 {
   tanker_expected_t* resource_id_expected =
@@ -361,6 +624,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 - (void)createGroupWithIdentities:(nonnull NSArray<NSString*>*)identities
                 completionHandler:(nonnull TKRGroupIDHandler)handler
 {
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
     if (err)
     {
@@ -376,15 +640,15 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   char** c_identities = TKR_convertStringstoCStrings(identities, &err);
   if (err)
   {
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(nil, err);
     });
     return;
   }
   tanker_future_t* future =
       tanker_create_group((tanker_t*)self.cTanker, (char const* const*)c_identities, identities.count);
-  tanker_future_t* resolve_future =
-      tanker_future_then(future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(future);
   tanker_future_destroy(resolve_future);
   TKR_freeCStringArray(c_identities, identities.count);
@@ -395,6 +659,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
                usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
            completionHandler:(nonnull TKRErrorHandler)handler
 {
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* unused, NSError* err) {
     handler(err);
   };
@@ -404,7 +669,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   char** identities_to_add = TKR_convertStringstoCStrings(usersToAdd, &err);
   if (err)
   {
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(err);
     });
     return;
@@ -412,7 +677,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   char** identities_to_remove = TKR_convertStringstoCStrings(usersToRemove, &err);
   if (err)
   {
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(err);
     });
     TKR_freeCStringArray(identities_to_add, usersToAdd.count);
@@ -424,8 +689,8 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
                                                         usersToAdd.count,
                                                         (char const* const*)identities_to_remove,
                                                         usersToRemove.count);
-  tanker_future_t* resolve_future =
-      tanker_future_then(future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(future);
   tanker_future_destroy(resolve_future);
   TKR_freeCStringArray(identities_to_add, usersToAdd.count);
@@ -439,10 +704,95 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   [self updateMembersOfGroup:groupId usersToAdd:userIdentities usersToRemove:@[] completionHandler:handler];
 }
 
+- (void)createGroupWithIdentities:(nonnull NSArray<NSString*>*)identities
+                        chunkSize:(NSUInteger)chunkSize
+                  progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+                completionHandler:(nonnull TKRGroupUpdateResultHandler)handler
+{
+  [self createGroupWithIdentities:identities
+                        chunkSize:chunkSize
+                cancellationToken:nil
+                  progressHandler:progressHandler
+                completionHandler:handler];
+}
+
+- (void)createGroupWithIdentities:(nonnull NSArray<NSString*>*)identities
+                        chunkSize:(NSUInteger)chunkSize
+                cancellationToken:(nullable TKRCancellationToken*)token
+                  progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+                completionHandler:(nonnull TKRGroupUpdateResultHandler)handler
+{
+  [[TKRBulkGroupUpdate updateWithTanker:self
+                                groupID:nil
+                             usersToAdd:identities
+                          usersToRemove:@[]
+                              chunkSize:chunkSize
+                      cancellationToken:token
+                        progressHandler:progressHandler
+                      completionHandler:handler] start];
+}
+
+- (void)updateMembersOfGroup:(nonnull NSString*)groupId
+                  usersToAdd:(nonnull NSArray<NSString*>*)usersToAdd
+               usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
+                   chunkSize:(NSUInteger)chunkSize
+             progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+           completionHandler:(nonnull TKRGroupUpdateResultHandler)handler
+{
+  [self updateMembersOfGroup:groupId
+                  usersToAdd:usersToAdd
+               usersToRemove:usersToRemove
+                   chunkSize:chunkSize
+           cancellationToken:nil
+             progressHandler:progressHandler
+           completionHandler:handler];
+}
+
+- (void)updateMembersOfGroup:(nonnull NSString*)groupId
+                  usersToAdd:(nonnull NSArray<NSString*>*)usersToAdd
+               usersToRemove:(nonnull NSArray<NSString*>*)usersToRemove
+                   chunkSize:(NSUInteger)chunkSize
+           cancellationToken:(nullable TKRCancellationToken*)token
+             progressHandler:(nullable TKRGroupUpdateProgressHandler)progressHandler
+           completionHandler:(nonnull TKRGroupUpdateResultHandler)handler
+{
+  [[TKRBulkGroupUpdate updateWithTanker:self
+                                groupID:groupId
+                             usersToAdd:usersToAdd
+                          usersToRemove:usersToRemove
+                              chunkSize:chunkSize
+                      cancellationToken:token
+                        progressHandler:progressHandler
+                      completionHandler:handler] start];
+}
+
 - (void)shareResourceIDs:(nonnull NSArray<NSString*>*)resourceIDs
                  options:(nonnull TKRSharingOptions*)options
        completionHandler:(nonnull TKRErrorHandler)handler
 {
+  if (self.options.shareCoalescingInterval <= 0 || resourceIDs.count == 0)
+  {
+    [self shareResourceIDsImpl:resourceIDs options:options completionHandler:handler];
+    return;
+  }
+
+  TKRShareBatcher* batcher;
+  @synchronized(self)
+  {
+    if (!self.shareBatcher)
+      self.shareBatcher = [TKRShareBatcher batcherWithTanker:self
+                                                    interval:self.options.shareCoalescingInterval
+                                                maxResources:self.options.shareCoalescingMaxResources ?: 100];
+    batcher = self.shareBatcher;
+  }
+  [batcher shareResourceIDs:resourceIDs options:options completionHandler:handler];
+}
+
+- (void)shareResourceIDsImpl:(nonnull NSArray<NSString*>*)resourceIDs
+                     options:(nonnull TKRSharingOptions*)options
+           completionHandler:(nonnull TKRErrorHandler)handler
+{
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* unused, NSError* err) {
     handler(err);
   };
@@ -451,7 +801,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   char** resource_ids = TKR_convertStringstoCStrings(resourceIDs, &err);
   if (err)
   {
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(err);
     });
     return;
@@ -461,7 +811,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   err = convertSharingOptions(options, &sharing_options);
   if (err)
   {
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(err);
     });
     return;
@@ -470,8 +820,8 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   tanker_future_t* share_future =
       tanker_share((tanker_t*)self.cTanker, (char const* const*)resource_ids, resourceIDs.count, &sharing_options);
 
-  tanker_future_t* resolve_future =
-      tanker_future_then(share_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      share_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
 
   tanker_future_destroy(share_future);
   tanker_future_destroy(resolve_future);
@@ -489,6 +839,8 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 - (void)createEncryptionSessionWithCompletionHandler:(nonnull TKREncryptionSessionHandler)handler
                                    encryptionOptions:(nonnull TKREncryptionOptions*)encryptionOptions
 {
+  TKR_TRACE_OPERATION();
+  dispatch_queue_t completionQueue = self.completionQueue;
   TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
     if (err)
     {
@@ -497,6 +849,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
     }
     TKREncryptionSession* encSess = [[TKREncryptionSession alloc] init];
     encSess.cSession = TKR_numberToPtr(ptrValue);
+    encSess.completionQueue = completionQueue;
     handler(encSess, nil);
   };
 
@@ -504,7 +857,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   NSError* err = convertEncryptionOptions(encryptionOptions, &encryption_options);
   if (err)
   {
-    TKR_runOnMainQueue(^{
+    TKR_runOnQueue(self.completionQueue, ^{
       handler(nil, err);
     });
     return;
@@ -512,8 +865,8 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 
   tanker_future_t* sess_future = tanker_encryption_session_open((tanker_t*)self.cTanker, &encryption_options);
 
-  tanker_future_t* resolve_future =
-      tanker_future_then(sess_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      sess_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
 
   tanker_future_destroy(sess_future);
   tanker_future_destroy(resolve_future);
@@ -524,6 +877,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 
 - (void)generateVerificationKeyWithCompletionHandler:(TKRVerificationKeyHandler)handler
 {
+  TKR_TRACE_OPERATION();
   TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
     if (err)
     {
@@ -539,8 +893,9 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   };
 
   tanker_expected_t* verification_key_fut = tanker_generate_verification_key((tanker_t*)self.cTanker);
-  tanker_future_t* resolve_future = tanker_future_then(
-      verification_key_fut, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(verification_key_fut,
+                                                       (tanker_future_then_t)&TKR_resolvePromise,
+                                                       TKR_bridgeAdapter(adapter, self.completionQueue));
 
   tanker_future_destroy(verification_key_fut);
   tanker_future_destroy(resolve_future);
@@ -548,12 +903,14 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 
 - (void)stopWithCompletionHandler:(nonnull TKRErrorHandler)handler
 {
+  TKR_TRACE_OPERATION();
+  [self resetVerificationMethodCache];
   TKRAdapter adapter = ^(NSNumber* unused, NSError* err) {
     handler(err);
   };
   tanker_future_t* stop_future = tanker_stop((tanker_t*)self.cTanker);
-  tanker_future_t* resolve_future =
-      tanker_future_then(stop_future, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
+  tanker_future_t* resolve_future = tanker_future_then(
+      stop_future, (tanker_future_then_t)&TKR_resolvePromise, TKR_bridgeAdapter(adapter, self.completionQueue));
   tanker_future_destroy(stop_future);
   tanker_future_destroy(resolve_future);
 }
@@ -567,13 +924,26 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
               options:(nonnull TKREncryptionOptions*)opts
     completionHandler:(nonnull TKRInputStreamHandler)handler
 {
+  [self encryptStream:clearStream options:opts cancellationToken:nil progressHandler:nil completionHandler:handler];
+}
+
+- (void)encryptStream:(nonnull NSInputStream*)clearStream
+              options:(nonnull TKREncryptionOptions*)opts
+    cancellationToken:(nullable TKRCancellationToken*)token
+      progressHandler:(nullable TKRStreamProgressHandler)progressHandler
+    completionHandler:(nonnull TKRInputStreamHandler)handler
+{
+  TKR_TRACE_OPERATION();
   if (clearStream.streamStatus != NSStreamStatusNotOpen)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, TKR_createNSError(TKRErrorInvalidArgument, @"Input stream status must be NSStreamStatusNotOpen"));
     return;
   }
 
   TKRAsyncStreamReader* reader = [TKRAsyncStreamReader readerWithStream:clearStream];
+  reader.progressHandler = progressHandler;
+  reader.progressQueue = self.completionQueue;
   clearStream.delegate = reader;
   // The main run loop is the only run loop that runs automatically
   NSRunLoop* runLoop = [NSRunLoop mainRunLoop];
@@ -584,6 +954,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
   NSError* err = convertEncryptionOptions(opts, &encryption_options);
   if (err)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, err);
     return;
   }
@@ -591,7 +962,7 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
                                                       (tanker_stream_input_source_t)&readInput,
                                                       (__bridge_retained void*)reader,
                                                       &encryption_options);
-  completeStreamEncrypt(reader, stream_fut, handler);
+  completeStreamEncrypt(reader, stream_fut, token, self.completionQueue, handler);
   tanker_future_destroy(stream_fut);
   TKR_freeCStringArray((char**)encryption_options.share_with_users, encryption_options.nb_users);
   TKR_freeCStringArray((char**)encryption_options.share_with_groups, encryption_options.nb_groups);
@@ -599,34 +970,33 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 
 - (void)decryptStream:(nonnull NSInputStream*)encryptedStream completionHandler:(nonnull TKRInputStreamHandler)handler
 {
+  [self decryptStream:encryptedStream cancellationToken:nil progressHandler:nil completionHandler:handler];
+}
+
+- (void)decryptStream:(nonnull NSInputStream*)encryptedStream
+    cancellationToken:(nullable TKRCancellationToken*)token
+      progressHandler:(nullable TKRStreamProgressHandler)progressHandler
+    completionHandler:(nonnull TKRInputStreamHandler)handler
+{
+  TKR_TRACE_OPERATION();
   if (encryptedStream.streamStatus != NSStreamStatusNotOpen)
   {
+    TKR_TRACE_CLEAR_OPERATION();
     handler(nil, TKR_createNSError(TKRErrorInvalidArgument, @"Input stream status must be NSStreamStatusNotOpen"));
     return;
   }
 
   TKRAsyncStreamReader* reader = [TKRAsyncStreamReader readerWithStream:encryptedStream];
+  reader.progressHandler = progressHandler;
+  reader.progressQueue = self.completionQueue;
   encryptedStream.delegate = reader;
   NSRunLoop* runLoop = [NSRunLoop mainRunLoop];
   [encryptedStream scheduleInRunLoop:runLoop forMode:NSDefaultRunLoopMode];
   [encryptedStream open];
 
-  TKRAdapter adapter = ^(NSNumber* ptrValue, NSError* err) {
-    if (err)
-    {
-      handler(nil, err);
-      return;
-    }
-    tanker_stream_t* stream = TKR_numberToPtr(ptrValue);
-    TKRStreamsFromNative* decryptionStream = [[TKRStreamsFromNative alloc] initWithCStream:stream asyncReader:reader];
-    handler(decryptionStream, nil);
-  };
-
   tanker_future_t* create_fut = tanker_stream_decrypt(
       (tanker_t*)self.cTanker, (tanker_stream_input_source_t)&readInput, (__bridge_retained void*)reader);
-  tanker_future_t* resolve_fut =
-      tanker_future_then(create_fut, (tanker_future_then_t)&TKR_resolvePromise, (__bridge_retained void*)adapter);
-  tanker_future_destroy(resolve_fut);
+  completeStreamEncrypt(reader, create_fut, token, self.completionQueue, handler);
   tanker_future_destroy(create_fut);
 }
 
@@ -637,9 +1007,22 @@ static void convertOptions(TKRTankerOptions const* options, tanker_options_t* cO
 
 - (void)dealloc
 {
-  tanker_future_t* destroy_future = tanker_destroy((tanker_t*)self.cTanker);
-  tanker_future_wait(destroy_future);
-  tanker_future_destroy(destroy_future);
+  tanker_t* c_tanker = (tanker_t*)self.cTanker;
+  // creation failed
+  if (!c_tanker)
+    return;
+  // retained when the native instance was created
+  void* http_data = (__bridge void*)self.options;
+  NSString* datastoreSettingsDir = self.datastoreSettingsDir;
+  // Destroying waits for the operations in flight and closes the databases, do not block the releasing thread
+  dispatch_async(TKR_lifecycleQueue(), ^{
+    tanker_future_t* destroy_future = tanker_destroy(c_tanker);
+    tanker_future_wait(destroy_future);
+    tanker_future_destroy(destroy_future);
+    (void)(__bridge_transfer TKRTankerOptions*)http_data;
+    // the datastores are closed
+    unregisterDatastoreSettings(datastoreSettingsDir);
+  });
 }
 
 @end
@@ -2,12 +2,14 @@ import Foundation
 
 // A numeric key for the associated ctanker object (must match the objc value)
 private var AssociatedCTankerHandle: UInt8 = 0
+// A numeric key for the associated public identity of the started user
+private var AssociatedPublicIdentityHandle: UInt8 = 0
 
 @objc(TKRTanker)
 public extension Tanker {
   static let TANKER_IOS_VERSION = "9999.0.0";
 
-  private var cTanker: OpaquePointer? {
+  internal var cTanker: OpaquePointer? {
     get {
         return objc_getAssociatedObject(self, &AssociatedCTankerHandle) as! OpaquePointer?
     }
@@ -16,6 +18,21 @@ public extension Tanker {
     }
   }
 
+  internal var publicIdentity: String? {
+    get {
+        return objc_getAssociatedObject(self, &AssociatedPublicIdentityHandle) as! String?
+    }
+    set {
+        objc_setAssociatedObject(self, &AssociatedPublicIdentityHandle, newValue, objc_AssociationPolicy.OBJC_ASSOCIATION_COPY)
+    }
+  }
+
+  private var completionQueue: DispatchQueue {
+    get {
+        return self.options.completionQueue ?? DispatchQueue.main
+    }
+  }
+
   @objc
   static func prehashPassword(_ password: String) throws -> String {
     let cPassword = password.cString(using: .utf8);
@@ -41,6 +58,7 @@ public extension Tanker {
 
   @objc
   func start(identity: String, completionHandler handler: @escaping (_ status: Status, _ error: NSError?) -> ()) {
+    traceOperation();
     let adapter: Adapter = {(status: NSNumber?, error: (any Swift.Error)?) in
       if (error != nil) {
         handler(Status(rawValue: 0)!, error as NSError?);
@@ -48,8 +66,10 @@ public extension Tanker {
         handler(Status(rawValue: status!.uintValue)!, nil);
       }
     };
-    let bridgeRetainedAdapter = Unmanaged.passRetained(adapter as AnyObject).toOpaque();
+    let bridgeRetainedAdapter = TKR_bridgeAdapter(adapter, self.completionQueue);
 
+    // an invalid identity is reported by tanker_start
+    self.publicIdentity = try? getExpectedString(tanker_get_public_identity(identity.cString(using: .utf8))!);
     let startFuture = tanker_start(self.cTanker, identity.cString(using: .utf8));
     let resolveFuture = tanker_future_then(startFuture, resolvePromise, bridgeRetainedAdapter)
     tanker_future_destroy(startFuture);
@@ -68,6 +88,7 @@ public extension Tanker {
   func registerIdentity(verification: Verification,
                         options: VerificationOptions,
                         completionHandler handler: @escaping (_ sessionToken: String?, _ error: NSError?) -> ()) {
+    traceOperation();
     let adapter: Adapter = {(tokenPtrVal: NSNumber?, error: (any Swift.Error)?) in
       let tokenPtr = UnsafeRawPointer(bitPattern: tokenPtrVal?.uintValue ?? 0)
       if (error != nil || tokenPtr == nil) {
@@ -78,7 +99,7 @@ public extension Tanker {
         handler(sessToken, nil)
       }
     }
-    let bridgeRetainedAdapter = Unmanaged.passRetained(adapter as AnyObject).toOpaque()
+    let bridgeRetainedAdapter = TKR_bridgeAdapter(adapter, self.completionQueue)
 
     let cOptions = options.toCVerificationOptions()
     let cVerif = verification.toCVerification()
@@ -105,6 +126,7 @@ public extension Tanker {
   func verifyIdentity(verification: Verification,
                       options: VerificationOptions,
                       completionHandler handler: @escaping (_ sessionToken: String?, _ error: NSError?) -> ()) {
+    traceOperation();
     let adapter: Adapter = {(tokenPtrVal: NSNumber?, error: (any Swift.Error)?) in
       let tokenPtr = UnsafeRawPointer(bitPattern: tokenPtrVal?.uintValue ?? 0)
       if (error != nil || tokenPtr == nil) {
@@ -115,7 +137,7 @@ public extension Tanker {
         handler(sessToken, nil)
       }
     }
-    let bridgeRetainedAdapter = Unmanaged.passRetained(adapter as AnyObject).toOpaque()
+    let bridgeRetainedAdapter = TKR_bridgeAdapter(adapter, self.completionQueue)
 
     let cOptions = options.toCVerificationOptions()
     let cVerif = verification.toCVerification()
@@ -142,8 +164,12 @@ public extension Tanker {
   func setVerificationMethod(verification: Verification,
                              options: VerificationOptions,
                              completionHandler handler: @escaping (_ sessionToken: String?, _ error: NSError?) -> ()) {
+    traceOperation();
     let adapter: Adapter = {(tokenPtrVal: NSNumber?, error: (any Swift.Error)?) in
       let tokenPtr = UnsafeRawPointer(bitPattern: tokenPtrVal?.uintValue ?? 0)
+      if (error == nil) {
+        self.invalidateVerificationMethodCache()
+      }
       if (error != nil || tokenPtr == nil) {
         handler(nil, error as NSError?)
       } else {
@@ -152,7 +178,7 @@ public extension Tanker {
         handler(sessToken, nil)
       }
     }
-    let bridgeRetainedAdapter = Unmanaged.passRetained(adapter as AnyObject).toOpaque()
+    let bridgeRetainedAdapter = TKR_bridgeAdapter(adapter, self.completionQueue)
 
     let cOptions = options.toCVerificationOptions()
     let cVerif = verification.toCVerification()
@@ -170,10 +196,11 @@ public extension Tanker {
   @objc
   func verifyProvisionalIdentity(verification: Verification,
                                  completionHandler handler: @escaping (_ error: NSError?) -> ()) {
+    traceOperation();
     let adapter: Adapter = {(_unused: NSNumber?, error: (any Swift.Error)?) in
       handler(error as NSError?)
     }
-    let bridgeRetainedAdapter = Unmanaged.passRetained(adapter as AnyObject).toOpaque()
+    let bridgeRetainedAdapter = TKR_bridgeAdapter(adapter, self.completionQueue)
 
     let cVerif = verification.toCVerification()
 
@@ -189,6 +216,7 @@ public extension Tanker {
   func authenticateWithIDP(providerID: String,
                            cookie: String,
                            completionHandler handler: @escaping (_ verification: Verification?, _ error: NSError?) -> ()) {
+    traceOperation();
     let adapter: Adapter = {(verifPtrValue: NSNumber?, error: (any Swift.Error)?) in
       if (error != nil) {
         handler(nil, error as NSError?)
@@ -202,7 +230,7 @@ public extension Tanker {
         handler(verif, nil)
       }
     }
-    let bridgeRetainedAdapter = Unmanaged.passRetained(adapter as AnyObject).toOpaque()
+    let bridgeRetainedAdapter = TKR_bridgeAdapter(adapter, self.completionQueue)
 
     let authFuture = tanker_authenticate_with_idp(self.cTanker, providerID.cString(using: .utf8), cookie.cString(using: .utf8))
     let resolveFuture = tanker_future_then(authFuture, resolvePromise, bridgeRetainedAdapter)
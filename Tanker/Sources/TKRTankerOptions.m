@@ -1,6 +1,9 @@
 #import <Tanker/TKRTankerOptions+Private.h>
 
 @implementation TKRTankerOptions
+{
+  id<TKRHTTPTransport> _httpTransport;
+}
 
 + (instancetype)options
 {
@@ -9,6 +12,16 @@
   return opts;
 }
 
+- (nullable id<TKRHTTPTransport>)httpTransport
+{
+  return _httpTransport;
+}
+
+- (void)setHttpTransport:(nullable id<TKRHTTPTransport>)httpTransport
+{
+  _httpTransport = httpTransport;
+}
+
 - (nullable NSString*)trustchainID
 {
   return _appID;
@@ -0,0 +1,294 @@
+#import <Tanker/TKRTracer+Private.h>
+
+#include <os/lock.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TKR_TRACE_MAX_EVENTS 100000
+#define TKR_TRACE_MAX_NAMES 128
+// 4 buckets per power of two, so that a bucket is at most 25% wider than the previous one
+#define TKR_TRACE_BUCKETS 256
+
+typedef struct
+{
+  char const* name;
+  uint64_t operationID;
+  uint64_t start;
+  uint64_t end;
+  uint64_t threadID;
+} TKRTraceEvent;
+
+typedef struct
+{
+  char const* name;
+  uint64_t count;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+  uint64_t buckets[TKR_TRACE_BUCKETS];
+} TKRTraceNameStats;
+
+typedef struct
+{
+  uint64_t operationID;
+  char const* name;
+  uint64_t start;
+} TKRTracePendingOperation;
+
+atomic_bool TKR_tracingEnabled = false;
+
+static os_unfair_lock traceLock = OS_UNFAIR_LOCK_INIT;
+// guarded by traceLock
+static TKRTraceEvent* events;
+static size_t eventCount;
+static TKRTraceNameStats* stats;
+static size_t statsCount;
+
+static _Atomic(uint64_t) lastOperationID;
+static _Thread_local TKRTracePendingOperation pendingOperation;
+
+static size_t bucketIndex(uint64_t ns)
+{
+  if (ns < 4)
+    return (size_t)ns;
+  int const log = 63 - __builtin_clzll(ns);
+  return (size_t)log * 4 + ((ns >> (log - 2)) & 3);
+}
+
+static uint64_t bucketUpperBound(size_t index)
+{
+  if (index < 4)
+    return index + 1;
+  size_t const log = index / 4;
+  return (uint64_t)(4 + index % 4 + 1) << (log - 2);
+}
+
+// must be called with traceLock held
+static TKRTraceNameStats* _Nullable statsForName(char const* name)
+{
+  for (size_t i = 0; i < statsCount; ++i)
+  {
+    // names are mostly literals, comparing pointers first avoids most strcmp calls
+    if (stats[i].name == name || strcmp(stats[i].name, name) == 0)
+      return &stats[i];
+  }
+  if (statsCount == TKR_TRACE_MAX_NAMES)
+    return NULL;
+  TKRTraceNameStats* ret = &stats[statsCount++];
+  memset(ret, 0, sizeof(*ret));
+  ret->name = name;
+  ret->min = UINT64_MAX;
+  return ret;
+}
+
+static uint64_t currentThreadID(void)
+{
+  uint64_t tid = 0;
+  pthread_threadid_np(NULL, &tid);
+  return tid;
+}
+
+uint64_t TKR_traceNow(void)
+{
+  return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+void TKR_traceRecordSpan(char const* name, uint64_t operationID, uint64_t start, uint64_t end)
+{
+  uint64_t const threadID = currentThreadID();
+  uint64_t const duration = end > start ? end - start : 0;
+
+  os_unfair_lock_lock(&traceLock);
+  if (!events)
+  {
+    events = malloc(sizeof(TKRTraceEvent) * TKR_TRACE_MAX_EVENTS);
+    stats = malloc(sizeof(TKRTraceNameStats) * TKR_TRACE_MAX_NAMES);
+  }
+  if (eventCount < TKR_TRACE_MAX_EVENTS)
+    events[eventCount++] = (TKRTraceEvent){
+        .name = name, .operationID = operationID, .start = start, .end = end, .threadID = threadID};
+  TKRTraceNameStats* nameStats = statsForName(name);
+  if (nameStats)
+  {
+    nameStats->count++;
+    nameStats->sum += duration;
+    nameStats->min = MIN(nameStats->min, duration);
+    nameStats->max = MAX(nameStats->max, duration);
+    nameStats->buckets[bucketIndex(duration)]++;
+  }
+  os_unfair_lock_unlock(&traceLock);
+}
+
+void TKR_traceBeginOperation(char const* name)
+{
+  pendingOperation = (TKRTracePendingOperation){
+      .operationID = atomic_fetch_add_explicit(&lastOperationID, 1, memory_order_relaxed) + 1,
+      .name = name,
+      .start = TKR_traceNow(),
+  };
+}
+
+void TKR_traceOperation(char const* name)
+{
+  if (TKR_traceEnabled())
+    TKR_traceBeginOperation(name);
+}
+
+static TKRTracePendingOperation takePendingOperation(void)
+{
+  TKRTracePendingOperation ret = pendingOperation;
+  pendingOperation = (TKRTracePendingOperation){0};
+  return ret;
+}
+
+void TKR_traceClearOperation(void)
+{
+  pendingOperation = (TKRTracePendingOperation){0};
+}
+
+void* TKR_traceBridgeAdapter(TKRAdapter adapter, dispatch_queue_t queue)
+{
+  // native calls made outside of a traced operation are still recorded, with operation 0
+  TKRTracePendingOperation const op = takePendingOperation();
+  uint64_t const bridged = TKR_traceNow();
+  if (op.operationID)
+    TKR_traceRecordSpan("marshalling", op.operationID, op.start, bridged);
+
+  TKRAdapter traced = ^(NSNumber* ptrValue, NSError* err) {
+    uint64_t const resolved = TKR_traceNow();
+    TKR_traceRecordSpan("native", op.operationID, bridged, resolved);
+
+    void (^complete)(void) = ^{
+      TKR_traceRecordSpan("completion", op.operationID, resolved, TKR_traceNow());
+      adapter(ptrValue, err);
+      if (op.operationID)
+        TKR_traceRecordSpan(op.name, op.operationID, op.start, TKR_traceNow());
+    };
+    if (queue)
+      dispatch_async(queue, complete);
+    else
+      complete();
+  };
+  return (__bridge_retained void*)traced;
+}
+
+void (^TKR_traceCompletion(void (^block)(void)))(void)
+{
+  TKRTracePendingOperation const op = takePendingOperation();
+  if (!op.operationID)
+    return block;
+
+  uint64_t const scheduled = TKR_traceNow();
+  TKR_traceRecordSpan("marshalling", op.operationID, op.start, scheduled);
+  return ^{
+    TKR_traceRecordSpan("completion", op.operationID, scheduled, TKR_traceNow());
+    block();
+    TKR_traceRecordSpan(op.name, op.operationID, op.start, TKR_traceNow());
+  };
+}
+
+@interface TKRTraceHistogram ()
+
+@property(readwrite) NSUInteger count;
+@property(readwrite) NSTimeInterval min;
+@property(readwrite) NSTimeInterval max;
+@property(readwrite) NSTimeInterval mean;
+@property(nonnull) NSData* buckets;
+
+@end
+
+@implementation TKRTraceHistogram
+
+- (NSTimeInterval)percentile:(double)fraction
+{
+  uint64_t const* buckets = self.buckets.bytes;
+  double const target = MIN(MAX(fraction, 0), 1) * self.count;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < TKR_TRACE_BUCKETS; ++i)
+  {
+    seen += buckets[i];
+    if (seen > 0 && seen >= target)
+      return MIN(bucketUpperBound(i) / 1e9, self.max);
+  }
+  return self.max;
+}
+
+@end
+
+@implementation TKRTracer
+
++ (void)setEnabled:(BOOL)enabled
+{
+  atomic_store(&TKR_tracingEnabled, enabled);
+}
+
++ (BOOL)isEnabled
+{
+  return TKR_traceEnabled();
+}
+
++ (void)reset
+{
+  os_unfair_lock_lock(&traceLock);
+  eventCount = 0;
+  statsCount = 0;
+  os_unfair_lock_unlock(&traceLock);
+}
+
++ (nonnull NSData*)chromeTraceJSON
+{
+  NSMutableArray<NSDictionary*>* traceEvents = [NSMutableArray array];
+  NSNumber* pid = @(getpid());
+
+  os_unfair_lock_lock(&traceLock);
+  size_t const count = eventCount;
+  TKRTraceEvent* snapshot = malloc(sizeof(TKRTraceEvent) * (count ?: 1));
+  if (count)
+    memcpy(snapshot, events, sizeof(TKRTraceEvent) * count);
+  os_unfair_lock_unlock(&traceLock);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    TKRTraceEvent const* event = &snapshot[i];
+    [traceEvents addObject:@{
+      @"name" : [NSString stringWithUTF8String:event->name],
+      @"cat" : @"tanker",
+      @"ph" : @"X",
+      @"ts" : @(event->start / 1e3),
+      @"dur" : @((event->end - event->start) / 1e3),
+      @"pid" : pid,
+      @"tid" : @(event->threadID),
+      @"args" : @{@"operation" : @(event->operationID)},
+    }];
+  }
+  free(snapshot);
+
+  NSData* ret = [NSJSONSerialization dataWithJSONObject:@{@"traceEvents" : traceEvents, @"displayTimeUnit" : @"ms"}
+                                                options:0
+                                                  error:nil];
+  return ret ?: [NSData data];
+}
+
++ (nonnull NSDictionary<NSString*, TKRTraceHistogram*>*)histograms
+{
+  NSMutableDictionary<NSString*, TKRTraceHistogram*>* ret = [NSMutableDictionary dictionary];
+
+  os_unfair_lock_lock(&traceLock);
+  for (size_t i = 0; i < statsCount; ++i)
+  {
+    TKRTraceNameStats const* nameStats = &stats[i];
+    TKRTraceHistogram* histogram = [[TKRTraceHistogram alloc] init];
+    histogram.count = (NSUInteger)nameStats->count;
+    histogram.min = nameStats->min / 1e9;
+    histogram.max = nameStats->max / 1e9;
+    histogram.mean = nameStats->sum / 1e9 / nameStats->count;
+    histogram.buckets = [NSData dataWithBytes:nameStats->buckets length:sizeof(nameStats->buckets)];
+    ret[[NSString stringWithUTF8String:nameStats->name]] = histogram;
+  }
+  os_unfair_lock_unlock(&traceLock);
+  return ret;
+}
+
+@end
@@ -5,4 +5,30 @@
 @synthesize email = _email;
 @synthesize type = _type;
 
+- (BOOL)isEqual:(id)other
+{
+  if (other == self)
+    return YES;
+  if (![other isKindOfClass:[TKRVerificationMethod class]])
+    return NO;
+  TKRVerificationMethod* method = other;
+  // only the properties matching the type are set
+  return self.type == method.type && (self.email == method.email || [self.email isEqualToString:method.email]) &&
+         (self.phoneNumber == method.phoneNumber || [self.phoneNumber isEqualToString:method.phoneNumber]) &&
+         (self.preverifiedEmail == method.preverifiedEmail ||
+          [self.preverifiedEmail isEqualToString:method.preverifiedEmail]) &&
+         (self.preverifiedPhoneNumber == method.preverifiedPhoneNumber ||
+          [self.preverifiedPhoneNumber isEqualToString:method.preverifiedPhoneNumber]) &&
+         (self.oidcProviderID == method.oidcProviderID ||
+          [self.oidcProviderID isEqualToString:method.oidcProviderID]) &&
+         (self.oidcProviderDisplayName == method.oidcProviderDisplayName ||
+          [self.oidcProviderDisplayName isEqualToString:method.oidcProviderDisplayName]);
+}
+
+- (NSUInteger)hash
+{
+  return self.type ^ self.email.hash ^ self.phoneNumber.hash ^ self.preverifiedEmail.hash ^
+         self.preverifiedPhoneNumber.hash ^ self.oidcProviderID.hash;
+}
+
 @end
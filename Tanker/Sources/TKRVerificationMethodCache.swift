@@ -0,0 +1,149 @@
+import Foundation
+
+private var AssociatedVerificationMethodCache: UInt8 = 0
+
+private let defaultVerificationMethodCacheMaxAge: TimeInterval = 60
+
+// Last verification methods fetched from the server, shared by all cachedVerificationMethods calls
+internal final class VerificationMethodCache {
+  let lock = NSLock();
+  var methods: [VerificationMethod]? = nil;
+  // False until the first fetch, and after an invalidation until the next fetch ends
+  var valid = false;
+  // System uptime of the last successful fetch, the methods are not revalidated during the max age after it
+  var fetchedAt: TimeInterval = 0;
+  // Bumped on each invalidation, a fetch started before that is outdated
+  var generation = 0;
+  var refreshing = false;
+  // Calls which could not be answered from the cache
+  var waiting: [([VerificationMethod]?, Error?) -> ()] = [];
+  var changeHandler: (([VerificationMethod]) -> ())? = nil;
+}
+
+@objc(TKRTanker)
+public extension Tanker {
+  internal var verificationMethodCache: VerificationMethodCache {
+    get {
+      objc_sync_enter(self)
+      defer { objc_sync_exit(self) }
+      if let cache = objc_getAssociatedObject(self, &AssociatedVerificationMethodCache) as? VerificationMethodCache {
+        return cache
+      }
+      let cache = VerificationMethodCache()
+      objc_setAssociatedObject(self, &AssociatedVerificationMethodCache, cache, .OBJC_ASSOCIATION_RETAIN)
+      return cache
+    }
+  }
+
+  @objc
+  var verificationMethodsChangeHandler: (([VerificationMethod]) -> ())? {
+    get {
+      let cache = self.verificationMethodCache
+      cache.lock.lock()
+      defer { cache.lock.unlock() }
+      return cache.changeHandler
+    }
+    set {
+      let cache = self.verificationMethodCache
+      cache.lock.lock()
+      defer { cache.lock.unlock() }
+      cache.changeHandler = newValue
+    }
+  }
+
+  @objc
+  func cachedVerificationMethods(completionHandler handler: @escaping ([VerificationMethod]?, Error?) -> ()) {
+    let configuredMaxAge = self.options.verificationMethodCacheMaxAge
+    let maxAge = configuredMaxAge > 0 ? configuredMaxAge : defaultVerificationMethodCacheMaxAge
+    let cache = self.verificationMethodCache
+    cache.lock.lock()
+    let cached = cache.valid ? cache.methods : nil
+    if cached == nil {
+      cache.waiting.append(handler)
+    }
+    let fresh = cached != nil && ProcessInfo.processInfo.systemUptime - cache.fetchedAt < maxAge
+    let fetch = !fresh && !cache.refreshing
+    if fetch {
+      cache.refreshing = true
+    }
+    cache.lock.unlock()
+
+    if let cached = cached {
+      let queue = self.options.completionQueue ?? DispatchQueue.main
+      queue.async {
+        handler(cached, nil)
+      }
+    }
+    // Revalidate stale methods even when answered from the cache, other devices may have changed them
+    if fetch {
+      self.refreshVerificationMethods(cache)
+    }
+  }
+
+  // Called after the methods were changed from this device
+  @objc
+  internal func invalidateVerificationMethodCache() {
+    let cache = self.verificationMethodCache
+    cache.lock.lock()
+    cache.valid = false
+    cache.generation += 1
+    // Only refetch for apps using the cache, the previous methods are kept to notify the change
+    let fetch = cache.methods != nil && !cache.refreshing
+    if fetch {
+      cache.refreshing = true
+    }
+    cache.lock.unlock()
+
+    if fetch {
+      self.refreshVerificationMethods(cache)
+    }
+  }
+
+  // Called on stop, the methods belong to the previous user
+  @objc
+  internal func resetVerificationMethodCache() {
+    let cache = self.verificationMethodCache
+    cache.lock.lock()
+    cache.methods = nil
+    cache.valid = false
+    cache.generation += 1
+    cache.lock.unlock()
+  }
+
+  private func refreshVerificationMethods(_ cache: VerificationMethodCache) {
+    cache.lock.lock()
+    let generation = cache.generation
+    cache.lock.unlock()
+
+    self.verificationMethods { (methods: [VerificationMethod]?, error: Error?) in
+      cache.lock.lock()
+      if error == nil && generation != cache.generation {
+        // Invalidated while fetching, the result may not include the change
+        cache.lock.unlock()
+        self.refreshVerificationMethods(cache)
+        return
+      }
+      let waiting = cache.waiting
+      cache.waiting = []
+      cache.refreshing = false
+      var changeHandler: (([VerificationMethod]) -> ())? = nil
+      if let methods = methods {
+        if let previous = cache.methods, previous != methods {
+          changeHandler = cache.changeHandler
+        }
+        cache.methods = methods
+        cache.valid = true
+        cache.fetchedAt = ProcessInfo.processInfo.systemUptime
+      }
+      cache.lock.unlock()
+
+      // Errors are only given to the calls waiting for this fetch, the cache is left as it was
+      for waitingHandler in waiting {
+        waitingHandler(methods, error)
+      }
+      if let changeHandler = changeHandler {
+        changeHandler(methods!)
+      }
+    }
+  }
+}
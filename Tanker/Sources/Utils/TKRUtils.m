@@ -1,5 +1,7 @@
 #import <Foundation/Foundation.h>
 
+#import <Tanker/TKRError.h>
+#import <Tanker/TKRTracer+Private.h>
 #import <Tanker/Utils/TKRUtils.h>
 
 #include <Tanker/ctanker.h>
@@ -43,11 +45,33 @@ NSError* TKR_getOptionalFutureError(void* future)
 
 void TKR_runOnMainQueue(void (^block)(void))
 {
-  dispatch_async(dispatch_get_main_queue(), ^{
+  TKR_runOnQueue(dispatch_get_main_queue(), block);
+}
+
+void TKR_runOnQueue(dispatch_queue_t queue, void (^block)(void))
+{
+  if (TKR_traceEnabled())
+    block = TKR_traceCompletion(block);
+  dispatch_async(queue, ^{
     block();
   });
 }
 
+void* TKR_bridgeAdapter(TKRAdapter adapter, dispatch_queue_t queue)
+{
+  if (TKR_traceEnabled())
+    return TKR_traceBridgeAdapter(adapter, queue);
+  if (!queue)
+    return (__bridge_retained void*)adapter;
+
+  TKRAdapter onQueue = ^(NSNumber* ptrValue, NSError* err) {
+    dispatch_async(queue, ^{
+      adapter(ptrValue, err);
+    });
+  };
+  return (__bridge_retained void*)onQueue;
+}
+
 // To understand the __bridge_madness: https://stackoverflow.com/a/14782488/4116453
 // and https://stackoverflow.com/a/14207961/4116453
 void* TKR_resolvePromise(void* future, void* arg)
@@ -63,17 +87,16 @@ void* TKR_resolvePromise(void* future, void* arg)
     // https://developer.apple.com/library/content/documentation/General/Conceptual/CocoaTouch64BitGuide/ConvertingYourAppto64-Bit/ConvertingYourAppto64-Bit.html
     ptrValue = [NSNumber numberWithUnsignedLongLong:(uintptr_t)ptr];
   }
-  dispatch_async(dispatch_get_main_queue(), ^{
-    TKRAdapter resolve = (__bridge_transfer typeof(TKRAdapter))arg;
-    resolve(ptrValue, optErr);
-  });
+  // arg comes from TKR_bridgeAdapter, which takes care of hopping on the completion queue
+  TKRAdapter resolve = (__bridge_transfer typeof(TKRAdapter))arg;
+  resolve(ptrValue, optErr);
   return nil;
 }
 
 void TKR_freeCStringArray(char** toFree, NSUInteger nbElems)
 {
-  for (int i = 0; i < nbElems; ++i)
-    free(toFree[i]);
+  // the strings live in the same allocation as the array, see TKR_convertStringstoCStrings
+  (void)nbElems;
   free(toFree);
 }
 
@@ -92,57 +115,109 @@ void* TKR_unwrapAndFreeExpected(void* expected, NSError** err)
   return ptr;
 }
 
+static NSError* allocationError(NSString* message)
+{
+  return [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:@{NSLocalizedDescriptionKey : message}];
+}
+
+static NSError* encodingError(void)
+{
+  return TKR_createNSError(TKRErrorInvalidArgument, @"string cannot be encoded as UTF-8");
+}
+
+NSError* TKR_createDecodingError(void)
+{
+  return TKR_createNSError(TKRErrorInvalidArgument, @"decrypted data is not a valid UTF-8 string");
+}
+
+// Returns the string's own contiguous UTF-8 storage when it has one, which avoids any conversion or copy
+static char const* contiguousUTF8(NSString* str)
+{
+  CFStringRef cfStr = (__bridge CFStringRef)str;
+  char const* ptr = CFStringGetCStringPtr(cfStr, kCFStringEncodingUTF8);
+  // ASCII is a subset of UTF-8, most identities and IDs are stored this way
+  return ptr ?: CFStringGetCStringPtr(cfStr, kCFStringEncodingASCII);
+}
+
 char* TKR_copyUTF8CString(NSString* str, NSError* _Nullable* _Nonnull err)
 {
-  size_t const length = strlen(str.UTF8String);
+  char const* utf8 = contiguousUTF8(str) ?: str.UTF8String;
+  if (!utf8)
+  {
+    *err = encodingError();
+    return nil;
+  }
+  size_t const length = strlen(utf8);
   char* utf8_cstr = (char*)malloc(length + 1);
   if (!utf8_cstr)
   {
-    *err = [NSError errorWithDomain:NSPOSIXErrorDomain
-                               code:ENOMEM
-                           userInfo:@{NSLocalizedDescriptionKey : @"could not allocate UTF-8 C string buffer"}];
+    *err = allocationError(@"could not allocate UTF-8 C string buffer");
     return nil;
   }
-  memcpy(utf8_cstr, str.UTF8String, length);
-  utf8_cstr[length] = '\0';
-  err = nil;
+  memcpy(utf8_cstr, utf8, length + 1);
   return utf8_cstr;
 }
 
 NSData* TKR_convertStringToData(NSString* clearText, NSError* _Nullable* _Nonnull err)
 {
-  char* clear_text = TKR_copyUTF8CString(clearText, err);
-  if (*err)
-    return nil;
-  return [NSData dataWithBytesNoCopy:clear_text length:strlen(clear_text) freeWhenDone:YES];
+  char const* utf8 = contiguousUTF8(clearText);
+  NSData* data = utf8 ? [NSData dataWithBytes:utf8 length:strlen(utf8)]
+                      : [clearText dataUsingEncoding:NSUTF8StringEncoding];
+  if (!data)
+    *err = encodingError();
+  return data;
 }
 
 char** TKR_convertStringstoCStrings(NSArray<NSString*>* strings, NSError* _Nullable* _Nonnull err)
 {
   if (!strings || strings.count == 0)
     return nil;
-  unsigned long const size_to_allocate = strings.count * sizeof(char*);
-  __block char** c_strs = (char**)malloc(size_to_allocate);
+
+  // the pointer array and every string are in a single allocation: first the pointers, then the strings
+  size_t size_to_allocate = strings.count * sizeof(char*);
+  for (NSString* str in strings)
+  {
+    char const* utf8 = contiguousUTF8(str);
+    NSUInteger const length = utf8 ? strlen(utf8) : [str lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    // 0 is also returned when the string cannot be encoded
+    if (length == 0 && str.length != 0)
+    {
+      *err = encodingError();
+      return nil;
+    }
+    size_to_allocate += length + 1;
+  }
+
+  char** c_strs = (char**)malloc(size_to_allocate);
   if (!c_strs)
   {
-    *err = [NSError errorWithDomain:NSPOSIXErrorDomain
-                               code:ENOMEM
-                           userInfo:@{NSLocalizedDescriptionKey : @"could not allocate array UTF-8 C strings"}];
+    *err = allocationError(@"could not allocate array UTF-8 C strings");
     return nil;
   }
 
-  __block NSError* err2 = nil;
-  [strings enumerateObjectsUsingBlock:^(NSString* str, NSUInteger idx, BOOL* stop) {
-    c_strs[idx] = TKR_copyUTF8CString(str, &err2);
-    if (err2)
+  char* cursor = (char*)(c_strs + strings.count);
+  char* const end = (char*)c_strs + size_to_allocate;
+  NSUInteger idx = 0;
+  for (NSString* str in strings)
+  {
+    c_strs[idx++] = cursor;
+    char const* utf8 = contiguousUTF8(str);
+    NSUInteger length;
+    if (utf8)
     {
-      for (; idx != 0; --idx)
-        free(c_strs[idx]);
-      *stop = YES;
-      free(c_strs);
-      c_strs = nil;
+      length = strlen(utf8);
+      memcpy(cursor, utf8, length);
     }
-  }];
-  *err = err2;
+    else
+      [str getBytes:cursor
+               maxLength:end - cursor
+              usedLength:&length
+                encoding:NSUTF8StringEncoding
+                 options:0
+                   range:NSMakeRange(0, str.length)
+          remainingRange:NULL];
+    cursor[length] = '\0';
+    cursor += length + 1;
+  }
   return c_strs;
 }
@@ -17,6 +17,12 @@ internal func getFutureError(_ fut: OpaquePointer) -> NSError? {
   return TKR_createNSError(UInt(err.code), String(cString: err.message)) as NSError;
 }
 
+// Starts a traced operation named after the calling function, see TKR_TRACE_OPERATION
+internal func traceOperation(_ name: StaticString = #function) {
+  // StaticString storage lives as long as the process, as the tracer requires
+  TKR_traceOperation(UnsafeRawPointer(name.utf8Start).assumingMemoryBound(to: CChar.self));
+}
+
 func resolvePromise(_ fut: OpaquePointer?, _ arg: UnsafeMutableRawPointer?) -> UnsafeMutableRawPointer? {
   let maybeErr = getFutureError(fut!);
   var ptrValue: NSNumber? = nil;
@@ -25,10 +31,9 @@ func resolvePromise(_ fut: OpaquePointer?, _ arg: UnsafeMutableRawPointer?) -> U
     ptrValue = NSNumber(value: UInt(bitPattern: tanker_future_get_voidptr(fut)));
   }
 
-  DispatchQueue.main.async(execute: {
-    let adapter = Unmanaged<AnyObject>.fromOpaque(arg!).takeRetainedValue() as! Adapter;
-    adapter(ptrValue, maybeErr);
-  });
+  // arg comes from TKR_bridgeAdapter, which takes care of hopping on the completion queue
+  let adapter = Unmanaged<AnyObject>.fromOpaque(arg!).takeRetainedValue() as! Adapter;
+  adapter(ptrValue, maybeErr);
   return nil;
 };
 
@@ -44,3 +49,118 @@ public func unwrapAndFreeExpected(_ expected: OpaquePointer) throws -> UnsafeMut
 
   return ptr;
 }
+
+// Resumes a continuation from a native future callback, without hopping on any queue.
+// The box outlives the awaiting task when it is cancelled: it keeps the buffers given to the
+// native call alive until the future completes, then discards the late result.
+internal final class FutureContinuation {
+  private let lock = NSLock();
+  private var continuation: CheckedContinuation<UnsafeMutableRawPointer?, Swift.Error>?;
+  private var cancelled = false;
+  private let keepAlive: [AnyObject];
+  private let discardResult: (UnsafeMutableRawPointer?) -> ();
+
+  init(keepAlive: [AnyObject], discardResult: @escaping (UnsafeMutableRawPointer?) -> ()) {
+    self.keepAlive = keepAlive;
+    self.discardResult = discardResult;
+  }
+
+  func install(_ continuation: CheckedContinuation<UnsafeMutableRawPointer?, Swift.Error>) {
+    lock.lock();
+    if cancelled {
+      lock.unlock();
+      continuation.resume(throwing: CancellationError());
+      return;
+    }
+    self.continuation = continuation;
+    lock.unlock();
+  }
+
+  func cancel() {
+    lock.lock();
+    cancelled = true;
+    let continuation = self.continuation;
+    self.continuation = nil;
+    lock.unlock();
+    continuation?.resume(throwing: CancellationError());
+  }
+
+  func complete(_ result: UnsafeMutableRawPointer?, _ error: NSError?) {
+    lock.lock();
+    let continuation = self.continuation;
+    self.continuation = nil;
+    lock.unlock();
+    guard let continuation = continuation else {
+      // nobody is waiting anymore, the task was cancelled
+      if error == nil {
+        discardResult(result);
+      }
+      return;
+    }
+    if let error = error {
+      continuation.resume(throwing: error);
+    } else {
+      continuation.resume(returning: result);
+    }
+  }
+}
+
+func resumeContinuation(_ fut: OpaquePointer?, _ arg: UnsafeMutableRawPointer?) -> UnsafeMutableRawPointer? {
+  let box = Unmanaged<FutureContinuation>.fromOpaque(arg!).takeRetainedValue();
+  let maybeErr = getFutureError(fut!);
+  box.complete(maybeErr == nil ? tanker_future_get_voidptr(fut) : nil, maybeErr);
+  return nil;
+}
+
+// Awaits a native future, and destroys it.
+//
+// Native futures cannot be cancelled: when the task is cancelled, this throws CancellationError right away,
+// while the operation runs to completion in the background. keepAlive must hold everything the native call
+// reads from or writes to, discardResult releases the result that nobody will read.
+@available(iOS 13.0, *)
+internal func awaitFuture(_ future: OpaquePointer,
+                          keepAlive: [AnyObject] = [],
+                          discardResult: @escaping (UnsafeMutableRawPointer?) -> () = { _ in }) async throws -> UnsafeMutableRawPointer? {
+  let box = FutureContinuation(keepAlive: keepAlive, discardResult: discardResult);
+  return try await withTaskCancellationHandler {
+    try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<UnsafeMutableRawPointer?, Swift.Error>) in
+      box.install(continuation);
+      let resolveFuture = tanker_future_then(future, resumeContinuation, Unmanaged.passRetained(box).toOpaque());
+      tanker_future_destroy(future);
+      tanker_future_destroy(resolveFuture);
+    }
+  } onCancel: {
+    box.cancel();
+  }
+}
+
+// A malloc'ed buffer given to a native call, freed unless its ownership is moved to a Data
+internal final class NativeBuffer {
+  private(set) var pointer: UnsafeMutablePointer<UInt8>?;
+
+  init(size: UInt64) throws {
+    // malloc(0) may return NULL
+    guard let ptr = malloc(Int(max(size, 1))) else {
+      throw TKR_createNSErrorWithDomain(NSPOSIXErrorDomain, UInt(ENOMEM), "could not allocate buffer") as NSError;
+    }
+    self.pointer = ptr.assumingMemoryBound(to: UInt8.self);
+  }
+
+  func toData(count: Int) -> Data {
+    let ptr = self.pointer!;
+    self.pointer = nil;
+    return Data(bytesNoCopy: ptr, count: count, deallocator: .free);
+  }
+
+  deinit {
+    free(self.pointer);
+  }
+}
+
+internal func withCStrings<R>(_ strings: [String], _ body: (UnsafePointer<UnsafePointer<CChar>?>?) throws -> R) rethrows -> R {
+  let cStrings: [UnsafePointer<CChar>?] = strings.map { UnsafePointer(strdup($0)) };
+  defer {
+    cStrings.forEach { free(UnsafeMutablePointer(mutating: $0)) };
+  }
+  return try cStrings.withUnsafeBufferPointer { try body($0.baseAddress) };
+}
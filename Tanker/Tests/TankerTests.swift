@@ -59,5 +59,210 @@ class TankerTests: TankerFunctionalQuickSpec {
         stop(tanker);
       }
     }
+
+    describe("async") {
+      var tanker: Tanker!;
+
+      beforeEach {
+        tanker = try! Tanker(options: self.tankerOptions);
+        let identity = createIdentity(appID: self.appID, appSecret: self.appSecret, userID: NSUUID().uuidString);
+        startAndRegister(tanker, identity, Verification(passphrase: "passphrase"));
+      }
+
+      afterEach {
+        stop(tanker);
+      }
+
+      it("should decrypt an encrypted string") {
+        guard #available(iOS 13.0, *) else { return }
+        waitUntil { done in
+          Task {
+            let encrypted = try! await tanker.encrypt("Rosebud");
+            expect(try! await tanker.decryptString(encrypted)) == "Rosebud";
+            done();
+          }
+        }
+      }
+
+      it("should fail to decrypt data which is not a string") {
+        guard #available(iOS 13.0, *) else { return }
+        waitUntil { done in
+          Task {
+            let encrypted = try! await tanker.encrypt(Data([0xff, 0xfe]));
+            do {
+              _ = try await tanker.decryptString(encrypted);
+              fail("decryption should have failed");
+            } catch {
+              expect((error as NSError).domain).to(equal(ErrorDomain));
+              expect((error as NSError).code) == Error.invalidArgument.rawValue;
+            }
+            done();
+          }
+        }
+      }
+
+      it("should decrypt data encrypted with an encryption session") {
+        guard #available(iOS 13.0, *) else { return }
+        waitUntil { done in
+          Task {
+            let session = try! await tanker.createEncryptionSession(options: EncryptionOptions());
+            let clearData = Data("Rosebud".utf8);
+            let encrypted = try! await session.encrypt(clearData);
+            expect(try! await tanker.decrypt(encrypted)) == clearData;
+            done();
+          }
+        }
+      }
+
+      it("should decrypt a stream of chunks encrypted as a stream of chunks") {
+        guard #available(iOS 13.0, *) else { return }
+        var clearData = Data(count: 3 * 1024 * 1024 + 2);
+        clearData.withUnsafeMutableBytes { arc4random_buf($0.baseAddress, $0.count) };
+        let clearChunks = AsyncStream<Data> { continuation in
+          stride(from: 0, to: clearData.count, by: 100_000).forEach { start in
+            continuation.yield(clearData.subdata(in: start..<min(start + 100_000, clearData.count)));
+          }
+          continuation.finish();
+        };
+        waitUntil(timeout: .seconds(10)) { done in
+          Task {
+            let encrypted = try! await tanker.encrypt(chunks: clearChunks);
+            let decrypted = try! await tanker.decrypt(chunks: encrypted);
+            var result = Data();
+            for try await chunk in decrypted {
+              result.append(chunk);
+            }
+            expect(result) == clearData;
+            done();
+          }
+        }
+      }
+
+      it("should decrypt a stream encrypted with read-ahead") {
+        guard #available(iOS 13.0, *) else { return }
+        var clearData = Data(count: 5 * 1024 * 1024 + 3);
+        clearData.withUnsafeMutableBytes { arc4random_buf($0.baseAddress, $0.count) };
+        waitUntil(timeout: .seconds(10)) { done in
+          Task {
+            let encrypted = try! await tanker.encrypt(stream: InputStream(data: clearData), readAhead: 2);
+            let decrypted = try! await tanker.decrypt(chunks: encrypted, readAhead: 3);
+            var result = Data();
+            for try await chunk in decrypted {
+              result.append(chunk);
+            }
+            expect(result) == clearData;
+            done();
+          }
+        }
+      }
+
+      it("should decrypt a stream encrypted with the NSInputStream API") {
+        guard #available(iOS 13.0, *) else { return }
+        let clearData = Data("Rosebud".utf8);
+        waitUntil { done in
+          Task {
+            let encryptedStream = try! await tanker.encryptStream(InputStream(data: clearData));
+            let decrypted = try! await tanker.decrypt(stream: encryptedStream);
+            var result = Data();
+            for try await chunk in decrypted {
+              result.append(chunk);
+            }
+            expect(result) == clearData;
+            done();
+          }
+        }
+      }
+
+      it("should report the error of the input sequence") {
+        guard #available(iOS 13.0, *) else { return }
+        let inputError = NSError(domain: "test", code: 42);
+        let failingChunks = AsyncThrowingStream<Data, Swift.Error> { continuation in
+          continuation.finish(throwing: inputError);
+        };
+        waitUntil { done in
+          Task {
+            do {
+              let encrypted = try await tanker.encrypt(chunks: failingChunks);
+              for try await _ in encrypted {}
+              fail("encryption should have failed");
+            } catch {
+              expect(error as NSError) == inputError;
+            }
+            done();
+          }
+        }
+      }
+
+      it("should decrypt byte ranges of an encrypted stream") {
+        guard #available(iOS 13.0, *) else { return }
+        var clearData = Data(count: 3 * 1024 * 1024 + 5);
+        clearData.withUnsafeMutableBytes { arc4random_buf($0.baseAddress, $0.count) };
+        waitUntil(timeout: .seconds(10)) { done in
+          Task {
+            var encryptedData = Data();
+            for try await chunk in try! await tanker.encrypt(stream: InputStream(data: clearData)) {
+              encryptedData.append(chunk);
+            }
+            var fetchCount = 0;
+            let source = EncryptedDataSource.blocks { offset, maxLength in
+              fetchCount += 1;
+              let start = min(Int(offset), encryptedData.count);
+              return encryptedData.subdata(in: start..<min(start + maxLength, encryptedData.count));
+            };
+            let reader = SeekableDecryptionReader(tanker: tanker, source: source, readAhead: 0);
+
+            let middle: Range<UInt64> = 1_500_000..<1_600_000;
+            expect(try! await reader.read(range: middle)) == clearData.subdata(in: 1_500_000..<1_600_000);
+            // the stream is not read until its end
+            expect(fetchCount) < 4;
+            // reading further continues where the previous read stopped
+            let next: Range<UInt64> = 2_000_000..<2_000_010;
+            expect(try! await reader.read(range: next)) == clearData.subdata(in: 2_000_000..<2_000_010);
+            // reading before starts over
+            let start: Range<UInt64> = 0..<10;
+            expect(try! await reader.read(range: start)) == clearData.subdata(in: 0..<10);
+            // a range past the end is truncated
+            let end = UInt64(clearData.count);
+            expect(try! await reader.read(range: (end - 3)..<(end + 100))) == clearData.suffix(3);
+            done();
+          }
+        }
+      }
+
+      it("should decrypt a byte range of an encrypted file") {
+        guard #available(iOS 13.0, *) else { return }
+        let clearData = Data("Rosebud, the sled".utf8);
+        let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(NSUUID().uuidString);
+        waitUntil { done in
+          Task {
+            var encryptedData = Data();
+            for try await chunk in try! await tanker.encrypt(stream: InputStream(data: clearData)) {
+              encryptedData.append(chunk);
+            }
+            try! encryptedData.write(to: fileURL);
+            let decrypted = try! await tanker.decrypt(range: 9..<17, from: .file(fileURL));
+            expect(String(data: decrypted, encoding: .utf8)) == "the sled";
+            try? FileManager.default.removeItem(at: fileURL);
+            done();
+          }
+        }
+      }
+
+      it("should throw CancellationError when the task is cancelled") {
+        guard #available(iOS 13.0, *) else { return }
+        waitUntil { done in
+          Task {
+            withUnsafeCurrentTask { $0?.cancel() };
+            do {
+              _ = try await tanker.encrypt("Rosebud");
+              fail("encrypt should have thrown");
+            } catch {
+              expect(error is CancellationError) == true;
+            }
+            done();
+          }
+        }
+      }
+    }
   }
 }
@@ -3,11 +3,16 @@
 #import <Tanker/Tanker-Swift.h>
 
 #import <Tanker/TKRAttachResult.h>
+#import <Tanker/TKRDataResult.h>
 #import <Tanker/TKREncryptionSession.h>
+#import <Tanker/TKREncryptionSessionPool.h>
 #import <Tanker/TKRError.h>
+#import <Tanker/TKRLogQueue+Private.h>
 #import <Tanker/TKRPadding.h>
+#import <Tanker/TKRTanker+Private.h>
 #import <Tanker/TKRTanker.h>
 #import <Tanker/TKRTankerOptions.h>
+#import <Tanker/TKRTracer.h>
 #import <Tanker/TKRVerificationKey.h>
 
 #import <Tanker/Utils/TKRUtils.h>
@@ -342,6 +347,149 @@ SpecBegin(TankerSpecs)
         tankerOptions = createTankerOptions(url, appID);
       });
 
+      describe(@"lifecycle", ^{
+        it(@"should create a Tanker asynchronously", ^{
+          TKRTanker* tanker = hangWithAdapter(^(PMKAdapter adapter) {
+            [TKRTanker tankerWithOptions:tankerOptions completionHandler:adapter];
+          });
+          expect(tanker).toNot.beNil();
+          expect(tanker.status).to.equal(TKRStatusStopped);
+          NSString* identity = createIdentity(createUUID(), appID, appSecret);
+          startWithIdentityAndRegister(tanker, identity, [[TKRVerification alloc] withPassphrase:@"passphrase"]);
+          stop(tanker);
+        });
+
+        it(@"should report creation errors asynchronously", ^{
+          tankerOptions.appID = @"this is not an app ID";
+          NSError* err = hangWithResolver(^(PMKResolver resolve) {
+            [TKRTanker tankerWithOptions:tankerOptions
+                       completionHandler:^(TKRTanker* tanker, NSError* err) {
+                         expect(tanker).to.beNil();
+                         resolve(err);
+                       }];
+          });
+          expect(err).toNot.beNil();
+          expect(err.code).to.equal(TKRErrorInvalidArgument);
+        });
+
+        it(@"should reopen the same storage right after releasing a Tanker", ^{
+          NSString* identity = createIdentity(createUUID(), appID, appSecret);
+          @autoreleasepool
+          {
+            TKRTanker* tanker = [TKRTanker tankerWithOptions:tankerOptions error:nil];
+            startWithIdentityAndRegister(tanker, identity, [[TKRVerification alloc] withPassphrase:@"passphrase"]);
+          }
+          TKRTanker* tanker = hangWithAdapter(^(PMKAdapter adapter) {
+            [TKRTanker tankerWithOptions:tankerOptions completionHandler:adapter];
+          });
+          NSNumber* status = hangWithResolver(^(PMKResolver resolve) {
+            [tanker startWithIdentity:identity
+                    completionHandler:^(TKRStatus status, NSError* err) {
+                      expect(err).to.beNil();
+                      resolve(@(status));
+                    }];
+          });
+          expect(status.unsignedIntegerValue).to.equal(TKRStatusReady);
+          stop(tanker);
+        });
+
+        it(@"should reject a Tanker sharing a cache path with other datastore settings", ^{
+          TKRTanker* first = [TKRTanker tankerWithOptions:tankerOptions error:nil];
+          expect(first).toNot.beNil();
+
+          TKRTankerOptions* sameSettings = createTankerOptions(url, appID);
+          sameSettings.cachePath = tankerOptions.cachePath;
+          NSError* err = nil;
+          expect([TKRTanker tankerWithOptions:sameSettings error:&err]).toNot.beNil();
+          expect(err).to.beNil();
+
+          TKRTankerOptions* otherSettings = createTankerOptions(url, appID);
+          otherSettings.cachePath = tankerOptions.cachePath;
+          otherSettings.datastoreWriteBehindDelay = 1;
+          expect([TKRTanker tankerWithOptions:otherSettings error:&err]).to.beNil();
+          expect(err).toNot.beNil();
+          expect(err.code).to.equal(TKRErrorInvalidArgument);
+        });
+      });
+
+      describe(@"logs", ^{
+        __block NSMutableArray<TKRLogEntry*>* entries;
+
+        __block void (^pushLog)(TKRLogLevel, NSString*) = ^(TKRLogLevel level, NSString* message) {
+          tanker_log_record_t record = {
+              .category = "tests", .level = level, .file = __FILE__, .line = __LINE__, .message = message.UTF8String};
+          TKR_logQueuePush(&record);
+        };
+
+        beforeEach(^{
+          entries = [NSMutableArray array];
+          [TKRTanker connectLogHandler:^(TKRLogEntry* entry) {
+            [entries addObject:entry];
+          }];
+        });
+
+        afterEach(^{
+          [TKRTanker setMinimumLogLevel:TKRLogLevelError];
+          [TKRTanker connectLogHandler:^(TKRLogEntry* entry) {
+            NSLog(@"Tanker Error: [%@] %@", entry.category, entry.message);
+          }];
+          TKR_logQueueFlush();
+        });
+
+        it(@"should only give logs above the minimum level to the handler", ^{
+          [TKRTanker setMinimumLogLevel:TKRLogLevelWarning];
+          pushLog(TKRLogLevelDebug, @"debug");
+          pushLog(TKRLogLevelInfo, @"info");
+          pushLog(TKRLogLevelWarning, @"warning");
+          pushLog(TKRLogLevelError, @"error");
+          TKR_logQueueFlush();
+
+          expect(entries.count).to.equal(2);
+          expect(entries[0].message).to.equal(@"warning");
+          expect(entries[0].level).to.equal(TKRLogLevelWarning);
+          expect(entries[0].category).to.equal(@"tests");
+          expect(entries[1].message).to.equal(@"error");
+        });
+
+        it(@"should truncate long messages on a character boundary", ^{
+          [TKRTanker setMinimumLogLevel:TKRLogLevelDebug];
+          NSString* message = [@"" stringByPaddingToLength:2000 withString:@"é" startingAtIndex:0];
+          pushLog(TKRLogLevelInfo, message);
+          TKR_logQueueFlush();
+
+          expect(entries.count).to.equal(1);
+          expect(entries[0].message.length).to.beGreaterThan(0);
+          expect([message hasPrefix:entries[0].message]).to.beTruthy();
+        });
+
+        it(@"should drop logs instead of blocking when the handler is slow", ^{
+          [TKRTanker setMinimumLogLevel:TKRLogLevelDebug];
+          dispatch_semaphore_t blocked = dispatch_semaphore_create(0);
+          dispatch_semaphore_t unblock = dispatch_semaphore_create(0);
+          __block NSUInteger handled = 0;
+          [TKRTanker connectLogHandler:^(TKRLogEntry* entry) {
+            if (handled++ == 0)
+            {
+              dispatch_semaphore_signal(blocked);
+              dispatch_semaphore_wait(unblock, DISPATCH_TIME_FOREVER);
+            }
+          }];
+          uint64_t const droppedBefore = [TKRTanker droppedLogCount];
+
+          pushLog(TKRLogLevelDebug, @"first");
+          dispatch_semaphore_wait(blocked, DISPATCH_TIME_FOREVER);
+          NSUInteger const pushed = TKR_LOG_QUEUE_CAPACITY + 50;
+          for (NSUInteger i = 0; i < pushed; ++i)
+            pushLog(TKRLogLevelDebug, @"flood");
+          uint64_t const dropped = [TKRTanker droppedLogCount] - droppedBefore;
+          dispatch_semaphore_signal(unblock);
+          TKR_logQueueFlush();
+
+          expect(dropped).to.equal(50);
+          expect(handled).to.equal(1 + pushed - dropped);
+        });
+      });
+
       describe(@"http", ^{
         it(@"reports http errors correctly", ^{
           // This error should be reported before any network call
@@ -485,6 +633,84 @@ SpecBegin(TankerSpecs)
           expect(decryptedData).to.equal(clearData);
         });
 
+        describe(@"batch", ^{
+          it(@"should decrypt a batch of encrypted data", ^{
+            NSArray<NSData*>* clearData = @[
+              [@"Rosebud" dataUsingEncoding:NSUTF8StringEncoding],
+              [@"" dataUsingEncoding:NSUTF8StringEncoding],
+              [@"Citizen Kane" dataUsingEncoding:NSUTF8StringEncoding]
+            ];
+
+            NSArray<TKRDataResult*>* encryptedResults = hangWithResolver(^(PMKResolver resolve) {
+              [tanker encryptDataBatch:clearData completionHandler:resolve];
+            });
+            expect(encryptedResults.count).to.equal(clearData.count);
+
+            NSMutableArray<NSData*>* encryptedData = [NSMutableArray array];
+            for (TKRDataResult* result in encryptedResults)
+            {
+              expect(result.error).to.beNil();
+              [encryptedData addObject:result.data];
+            }
+
+            NSArray<TKRDataResult*>* decryptedResults = hangWithResolver(^(PMKResolver resolve) {
+              [tanker decryptDataBatch:encryptedData completionHandler:resolve];
+            });
+            expect(decryptedResults.count).to.equal(clearData.count);
+            for (NSUInteger i = 0; i < clearData.count; ++i)
+            {
+              expect(decryptedResults[i].error).to.beNil();
+              expect(decryptedResults[i].data).to.equal(clearData[i]);
+            }
+          });
+
+          it(@"should report errors for each item of a batch", ^{
+            NSData* clearData = [@"Rosebud" dataUsingEncoding:NSUTF8StringEncoding];
+            NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker encryptData:clearData completionHandler:adapter];
+            });
+            NSData* corruptedData = [@"not encrypted" dataUsingEncoding:NSUTF8StringEncoding];
+
+            NSArray<TKRDataResult*>* results = hangWithResolver(^(PMKResolver resolve) {
+              [tanker decryptDataBatch:@[ corruptedData, encryptedData ] completionHandler:resolve];
+            });
+            expect(results.count).to.equal(2);
+            expect(results[0].data).to.beNil();
+            expect(results[0].error).toNot.beNil();
+            expect(results[0].error.domain).to.equal(TKRErrorDomain);
+            expect(results[1].error).to.beNil();
+            expect(results[1].data).to.equal(clearData);
+          });
+
+          it(@"should call the handler with an empty batch", ^{
+            NSArray<TKRDataResult*>* results = hangWithResolver(^(PMKResolver resolve) {
+              [tanker decryptDataBatch:@[] completionHandler:resolve];
+            });
+            expect(results.count).to.equal(0);
+          });
+
+          it(@"should fail every item of a batch cancelled beforehand", ^{
+            NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker encryptString:@"Rosebud" completionHandler:adapter];
+            });
+            TKRCancellationToken* token = [TKRCancellationToken token];
+            [token cancel];
+
+            NSArray<TKRDataResult*>* results = hangWithResolver(^(PMKResolver resolve) {
+              [tanker decryptDataBatch:@[ encryptedData, encryptedData ]
+                     cancellationToken:token
+                     completionHandler:resolve];
+            });
+            expect(results.count).to.equal(2);
+            for (TKRDataResult* result in results)
+            {
+              expect(result.data).to.beNil();
+              expect(result.error.domain).to.equal(TKRErrorDomain);
+              expect(result.error.code).to.equal(TKRErrorOperationCanceled);
+            }
+          });
+        });
+
         describe(@"padding", ^{
           it(@"should encrypt and decrypt with auto padding by default", ^{
             NSString* clearText = @"my clear data is clear!";
@@ -722,6 +948,82 @@ SpecBegin(TankerSpecs)
             expect(err.code).to.equal(TKRErrorInvalidArgument);
           });
 
+          it(@"should report the progress of a stream", ^{
+            NSMutableArray<NSNumber*>* progress = [NSMutableArray array];
+            NSInputStream* encryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker encryptStream:clearStream
+                            options:[[TKREncryptionOptions alloc] init]
+                  cancellationToken:nil
+                    progressHandler:^(uint64_t processedBytes) {
+                      [progress addObject:@(processedBytes)];
+                    }
+                  completionHandler:adapter];
+            });
+
+            [PMKPromise hang:[reader readAll:encryptedStream]];
+            expect(progress).toNot.beEmpty();
+            expect(progress.lastObject).to.equal(@(clearData.length));
+          });
+
+          it(@"should fail to read a stream cancelled while it is read", ^{
+            clearStream.isSlow = YES;
+            TKRCancellationToken* token = [TKRCancellationToken token];
+
+            NSInputStream* encryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker encryptStream:clearStream
+                            options:[[TKREncryptionOptions alloc] init]
+                  cancellationToken:token
+                    progressHandler:^(uint64_t processedBytes) {
+                      [token cancel];
+                    }
+                  completionHandler:adapter];
+            });
+
+            NSError* err = [PMKPromise hang:[reader readAll:encryptedStream]];
+            expect(err).toNot.beNil();
+            expect(err.domain).to.equal(TKRErrorDomain);
+            expect(err.code).to.equal(TKRErrorOperationCanceled);
+            expect(token.isCancelled).to.beTruthy();
+          });
+
+          it(@"should fail to create a decryption stream with a cancelled token", ^{
+            NSInputStream* encryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker encryptStream:clearStream completionHandler:adapter];
+            });
+            TKRCancellationToken* token = [TKRCancellationToken token];
+            [token cancel];
+
+            NSError* err = hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker decryptStream:encryptedStream
+                  cancellationToken:token
+                    progressHandler:nil
+                  completionHandler:adapter];
+            });
+            expect(err).toNot.beNil();
+            expect(err.domain).to.equal(TKRErrorDomain);
+            expect(err.code).to.equal(TKRErrorOperationCanceled);
+          });
+
+          it(@"should release the input of a decryption stream failing to be created", ^{
+            NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+              [tanker encryptData:[@"Rosebud" dataUsingEncoding:NSUTF8StringEncoding] completionHandler:adapter];
+            });
+            TKRCancellationToken* token = [TKRCancellationToken token];
+            [token cancel];
+            __weak NSInputStream* weakInput = nil;
+
+            @autoreleasepool
+            {
+              NSInputStream* input = [NSInputStream inputStreamWithData:encryptedData];
+              weakInput = input;
+              NSError* err = hangWithAdapter(^(PMKAdapter adapter) {
+                [tanker decryptStream:input cancellationToken:token progressHandler:nil completionHandler:adapter];
+              });
+              expect(err.code).to.equal(TKRErrorOperationCanceled);
+            }
+            expect(weakInput).will.beNil();
+          });
+
           it(@"does not support getBuffer function", ^{
             NSInputStream* encryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
               [tanker encryptStream:clearStream completionHandler:adapter];
@@ -734,6 +1036,198 @@ SpecBegin(TankerSpecs)
         });
       });
 
+      describe(@"completion queue", ^{
+        __block TKRTanker* tanker;
+        __block dispatch_queue_t completionQueue;
+        static char completionQueueKey;
+
+        beforeEach(^{
+          completionQueue = dispatch_queue_create("io.tanker.tests.completion", DISPATCH_QUEUE_SERIAL);
+          dispatch_queue_set_specific(completionQueue, &completionQueueKey, &completionQueueKey, NULL);
+          tankerOptions.completionQueue = completionQueue;
+          tanker = [TKRTanker tankerWithOptions:tankerOptions error:nil];
+          expect(tanker).toNot.beNil();
+          NSString* identity = createIdentity(createUUID(), appID, appSecret);
+          startWithIdentityAndRegister(tanker, identity, [[TKRVerification alloc] withPassphrase:@"passphrase"]);
+        });
+
+        afterEach(^{
+          stop(tanker);
+        });
+
+        it(@"should call handlers on the completion queue", ^{
+          NSNumber* onQueue = hangWithResolver(^(PMKResolver resolve) {
+            [tanker encryptString:@"Rosebud"
+                completionHandler:^(NSData* encryptedData, NSError* err) {
+                  resolve(@(dispatch_get_specific(&completionQueueKey) == &completionQueueKey));
+                }];
+          });
+          expect(onQueue.boolValue).to.beTruthy();
+        });
+
+        it(@"should call handlers on the completion queue when an error occurs early", ^{
+          NSNumber* onQueue = hangWithResolver(^(PMKResolver resolve) {
+            [tanker createGroupWithIdentities:@[]
+                            completionHandler:^(NSString* groupID, NSError* err) {
+                              resolve(@(dispatch_get_specific(&completionQueueKey) == &completionQueueKey));
+                            }];
+          });
+          expect(onQueue.boolValue).to.beTruthy();
+        });
+      });
+
+      describe(@"data to file", ^{
+        __block TKRTanker* tanker;
+        __block NSData* clearData;
+        __block NSURL* destination;
+
+        beforeEach(^{
+          tanker = [TKRTanker tankerWithOptions:tankerOptions error:nil];
+          expect(tanker).toNot.beNil();
+          NSString* identity = createIdentity(createUUID(), appID, appSecret);
+          startWithIdentityAndRegister(tanker, identity, [[TKRVerification alloc] withPassphrase:@"passphrase"]);
+          NSMutableData* data = [NSMutableData dataWithLength:3 * 1024 * 1024 + 2];
+          arc4random_buf(data.mutableBytes, data.length);
+          clearData = data;
+          destination = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:createUUID()]];
+        });
+
+        afterEach(^{
+          stop(tanker);
+          [[NSFileManager defaultManager] removeItemAtURL:destination error:nil];
+        });
+
+        it(@"should decrypt data encrypted to a file", ^{
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptData:clearData toFileAtURL:destination completionHandler:adapter];
+          });
+          NSData* decryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker decryptData:encryptedData completionHandler:adapter];
+          });
+
+          expect(decryptedData).to.equal(clearData);
+          expect([NSData dataWithContentsOfURL:destination]).to.equal(encryptedData);
+        });
+
+        it(@"should decrypt data encrypted to a file with decryptStream", ^{
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptData:clearData toFileAtURL:destination completionHandler:adapter];
+          });
+          NSInputStream* decryptedStream = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker decryptStream:[NSInputStream inputStreamWithData:encryptedData] completionHandler:adapter];
+          });
+          TKRTestAsyncStreamReader* reader = [[TKRTestAsyncStreamReader alloc] init];
+          NSData* decryptedData = [PMKPromise hang:[reader readAll:decryptedStream]];
+
+          expect(decryptedData).to.equal(clearData);
+        });
+
+        it(@"should decrypt memory-mapped data to a file", ^{
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptData:clearData toFileAtURL:destination completionHandler:adapter];
+          });
+          NSData* mappedData = [NSData dataWithContentsOfURL:destination options:NSDataReadingMappedAlways error:nil];
+          expect(mappedData).to.equal(encryptedData);
+          NSURL* clearDestination =
+              [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:createUUID()]];
+
+          NSData* decryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker decryptData:mappedData toFileAtURL:clearDestination completionHandler:adapter];
+          });
+
+          expect(decryptedData).to.equal(clearData);
+          expect([NSData dataWithContentsOfURL:clearDestination]).to.equal(clearData);
+          [[NSFileManager defaultManager] removeItemAtURL:clearDestination error:nil];
+        });
+
+        it(@"should remove the destination file when decryption fails", ^{
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptData:clearData toFileAtURL:destination completionHandler:adapter];
+          });
+          // corrupt the last chunk, so that the first ones are written before decryption fails
+          NSMutableData* corruptedData = [encryptedData mutableCopy];
+          ((uint8_t*)corruptedData.mutableBytes)[corruptedData.length - 1] ^= 1;
+          NSURL* clearDestination =
+              [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:createUUID()]];
+
+          NSError* err = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker decryptData:corruptedData toFileAtURL:clearDestination completionHandler:adapter];
+          });
+
+          expect(err).toNot.beNil();
+          expect([[NSFileManager defaultManager] fileExistsAtPath:clearDestination.path]).to.beFalsy();
+        });
+
+        it(@"should keep the format of encryptData for large data", ^{
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptData:clearData completionHandler:adapter];
+          });
+          NSData* streamEncryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptData:clearData toFileAtURL:destination completionHandler:adapter];
+          });
+
+          expect(encryptedData.length).toNot.equal(streamEncryptedData.length);
+        });
+      });
+
+      describe(@"tracing", ^{
+        __block TKRTanker* tanker;
+
+        beforeEach(^{
+          tanker = [TKRTanker tankerWithOptions:tankerOptions error:nil];
+          expect(tanker).toNot.beNil();
+          NSString* identity = createIdentity(createUUID(), appID, appSecret);
+          startWithIdentityAndRegister(tanker, identity, [[TKRVerification alloc] withPassphrase:@"passphrase"]);
+          [TKRTracer reset];
+        });
+
+        afterEach(^{
+          [TKRTracer setEnabled:NO];
+          [TKRTracer reset];
+          stop(tanker);
+        });
+
+        it(@"should not record anything when disabled", ^{
+          hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptString:@"Rosebud" completionHandler:adapter];
+          });
+          expect([TKRTracer histograms].count).to.equal(0);
+        });
+
+        it(@"should record the spans of an operation", ^{
+          [TKRTracer setEnabled:YES];
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker encryptString:@"Rosebud" completionHandler:adapter];
+          });
+          hangWithAdapter(^(PMKAdapter adapter) {
+            [tanker decryptStringFromData:encryptedData completionHandler:adapter];
+          });
+
+          NSDictionary<NSString*, TKRTraceHistogram*>* histograms = [TKRTracer histograms];
+          expect(histograms[@"-[TKRTanker encryptData:options:completionHandler:]"].count).to.equal(1);
+          expect(histograms[@"-[TKRTanker decryptStringFromData:completionHandler:]"].count).to.equal(1);
+          expect(histograms[@"marshalling"].count).to.equal(2);
+          expect(histograms[@"native"].count).to.beGreaterThanOrEqualTo(2);
+          expect(histograms[@"completion"].count).to.beGreaterThanOrEqualTo(2);
+          TKRTraceHistogram* native = histograms[@"native"];
+          expect([native percentile:0.5]).to.beLessThanOrEqualTo(native.max);
+          expect(native.min).to.beLessThanOrEqualTo(native.mean);
+
+          NSData* json = [TKRTracer chromeTraceJSON];
+          NSDictionary* trace = [NSJSONSerialization JSONObjectWithData:json options:0 error:nil];
+          NSArray<NSDictionary*>* events = trace[@"traceEvents"];
+          NSString* encryptName = @"-[TKRTanker encryptData:options:completionHandler:]";
+          NSIndexSet* encryptEvents =
+              [events indexesOfObjectsPassingTest:^(NSDictionary* event, NSUInteger i, BOOL* stop) {
+                return [event[@"name"] isEqualToString:encryptName];
+              }];
+          expect(encryptEvents.count).to.equal(1);
+          NSDictionary* encryptEvent = events[encryptEvents.firstIndex];
+          expect(encryptEvent[@"ph"]).to.equal(@"X");
+          expect([encryptEvent[@"args"][@"operation"] unsignedLongLongValue]).to.beGreaterThan(0);
+        });
+      });
+
       describe(@"groups", ^{
         __block TKRTanker* aliceTanker;
         __block TKRTanker* bobTanker;
@@ -912,6 +1406,106 @@ SpecBegin(TankerSpecs)
           expect(err).toNot.beNil();
           expect(err.code).to.equal(TKRErrorInvalidArgument);
         });
+
+        it(@"should create a group in chunks and report progress", ^{
+          NSMutableArray<NSNumber*>* progress = [NSMutableArray array];
+          TKRGroupUpdateResult* result = hangWithResolver(^(PMKResolver resolve) {
+            [aliceTanker createGroupWithIdentities:@[ alicePublicIdentity, bobPublicIdentity ]
+                                         chunkSize:1
+                                   progressHandler:^(NSUInteger processedCount, NSUInteger totalCount) {
+                                     expect(totalCount).to.equal(2);
+                                     [progress addObject:@(processedCount)];
+                                   }
+                                 completionHandler:resolve];
+          });
+          expect(result.error).to.beNil();
+          expect(result.groupID).toNot.beNil();
+          expect(result.pendingUsersToAdd).to.beEmpty();
+          expect(progress).to.equal(@[ @1, @2 ]);
+
+          TKREncryptionOptions* encryptionOptions = [[TKREncryptionOptions alloc] init];
+          encryptionOptions.shareWithGroups = @[ result.groupID ];
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [aliceTanker encryptString:@"Rosebud" options:encryptionOptions completionHandler:adapter];
+          });
+          NSString* decryptedString = hangWithAdapter(^(PMKAdapter adapter) {
+            [bobTanker decryptStringFromData:encryptedData completionHandler:adapter];
+          });
+          expect(decryptedString).to.equal(@"Rosebud");
+        });
+
+        it(@"should send the identity of the current user with the first chunk of a group creation", ^{
+          TKRGroupUpdateResult* result = hangWithResolver(^(PMKResolver resolve) {
+            [aliceTanker createGroupWithIdentities:@[ bobPublicIdentity, alicePublicIdentity ]
+                                         chunkSize:1
+                                   progressHandler:nil
+                                 completionHandler:resolve];
+          });
+          expect(result.error).to.beNil();
+          expect(result.groupID).toNot.beNil();
+          expect(result.pendingUsersToAdd).to.beEmpty();
+        });
+
+        it(@"should reject a group creation in chunks without the identity of the current user", ^{
+          NSString* charliePublicIdentity = getPublicIdentity(createIdentity(createUUID(), appID, appSecret));
+          NSArray<NSString*>* identities = @[ bobPublicIdentity, charliePublicIdentity ];
+          TKRGroupUpdateResult* result = hangWithResolver(^(PMKResolver resolve) {
+            [aliceTanker createGroupWithIdentities:identities
+                                         chunkSize:1
+                                   progressHandler:nil
+                                 completionHandler:resolve];
+          });
+          expect(result.error).toNot.beNil();
+          expect(result.error.code).to.equal(TKRErrorInvalidArgument);
+          expect(result.groupID).to.beNil();
+          expect(result.pendingUsersToAdd).to.equal(identities);
+        });
+
+        it(@"should return the users left to add when a chunk fails", ^{
+          NSString* groupId = hangWithAdapter(^(PMKAdapter adapter) {
+            [aliceTanker createGroupWithIdentities:@[ alicePublicIdentity ] completionHandler:adapter];
+          });
+          TKRGroupUpdateResult* result = hangWithResolver(^(PMKResolver resolve) {
+            [aliceTanker updateMembersOfGroup:groupId
+                                   usersToAdd:@[ bobPublicIdentity, @"no no no" ]
+                                usersToRemove:@[]
+                                    chunkSize:1
+                              progressHandler:nil
+                            completionHandler:resolve];
+          });
+          expect(result.error).toNot.beNil();
+          expect(result.error.code).to.equal(TKRErrorInvalidArgument);
+          expect(result.groupID).to.equal(groupId);
+          expect(result.pendingUsersToAdd).to.equal(@[ @"no no no" ]);
+
+          TKREncryptionOptions* encryptionOptions = [[TKREncryptionOptions alloc] init];
+          encryptionOptions.shareWithGroups = @[ groupId ];
+          NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+            [aliceTanker encryptString:@"Rosebud" options:encryptionOptions completionHandler:adapter];
+          });
+          NSString* decryptedString = hangWithAdapter(^(PMKAdapter adapter) {
+            [bobTanker decryptStringFromData:encryptedData completionHandler:adapter];
+          });
+          expect(decryptedString).to.equal(@"Rosebud");
+        });
+
+        it(@"should give back every identity of a chunked creation cancelled beforehand", ^{
+          TKRCancellationToken* token = [TKRCancellationToken token];
+          [token cancel];
+          NSArray<NSString*>* identities = @[ alicePublicIdentity, bobPublicIdentity ];
+          TKRGroupUpdateResult* result = hangWithResolver(^(PMKResolver resolve) {
+            [aliceTanker createGroupWithIdentities:identities
+                                         chunkSize:1
+                                 cancellationToken:token
+                                   progressHandler:nil
+                                 completionHandler:resolve];
+          });
+          expect(result.error).toNot.beNil();
+          expect(result.error.domain).to.equal(TKRErrorDomain);
+          expect(result.error.code).to.equal(TKRErrorOperationCanceled);
+          expect(result.groupID).to.beNil();
+          expect(result.pendingUsersToAdd).to.equal(identities);
+        });
       });
 
       describe(@"encryptionSession", ^{
@@ -944,6 +1538,63 @@ SpecBegin(TankerSpecs)
           stop(bobTanker);
         });
 
+        describe(@"pool", ^{
+          __block TKREncryptionSessionPool* pool;
+          __block TKREncryptionSession* (^getSession)(TKREncryptionOptions*) = ^(TKREncryptionOptions* opts) {
+            return hangWithAdapter(^(PMKAdapter adapter) {
+              [pool encryptionSessionWithOptions:opts completionHandler:adapter];
+            });
+          };
+
+          beforeEach(^{
+            pool = [TKREncryptionSessionPool poolWithTanker:aliceTanker];
+          });
+
+          it(@"should reuse a session for the same recipients, in any order", ^{
+            TKREncryptionOptions* opts = [[TKREncryptionOptions alloc] init];
+            opts.shareWithUsers = @[ bobPublicIdentity, alicePublicIdentity ];
+            TKREncryptionOptions* sameOpts = [[TKREncryptionOptions alloc] init];
+            sameOpts.shareWithUsers = @[ alicePublicIdentity, bobPublicIdentity, alicePublicIdentity ];
+
+            TKREncryptionSession* session = getSession(opts);
+            TKREncryptionSession* sameSession = getSession(sameOpts);
+            expect(sameSession.resourceID).to.equal(session.resourceID);
+          });
+
+          it(@"should not reuse a session for other recipients or padding", ^{
+            TKREncryptionOptions* opts = [[TKREncryptionOptions alloc] init];
+            opts.shareWithUsers = @[ bobPublicIdentity ];
+            TKREncryptionOptions* paddedOpts = [[TKREncryptionOptions alloc] init];
+            paddedOpts.shareWithUsers = @[ bobPublicIdentity ];
+            paddedOpts.paddingStep = [TKRPadding step:13 error:nil];
+
+            TKREncryptionSession* session = getSession(opts);
+            expect(getSession([[TKREncryptionOptions alloc] init]).resourceID).toNot.equal(session.resourceID);
+            expect(getSession(paddedOpts).resourceID).toNot.equal(session.resourceID);
+          });
+
+          it(@"should rotate a session after maxUsesPerSession uses", ^{
+            pool.maxUsesPerSession = 2;
+            TKREncryptionOptions* opts = [[TKREncryptionOptions alloc] init];
+
+            NSString* first = getSession(opts).resourceID;
+            expect(getSession(opts).resourceID).to.equal(first);
+            expect(getSession(opts).resourceID).toNot.equal(first);
+          });
+
+          it(@"should encrypt data that recipients can decrypt", ^{
+            TKREncryptionOptions* opts = [[TKREncryptionOptions alloc] init];
+            opts.shareWithUsers = @[ bobPublicIdentity ];
+            NSData* encryptedData = hangWithAdapter(^(PMKAdapter adapter) {
+              [pool encryptString:@"Rosebud" options:opts completionHandler:adapter];
+            });
+            NSString* decryptedString = hangWithAdapter(^(PMKAdapter adapter) {
+              [bobTanker decryptStringFromData:encryptedData completionHandler:adapter];
+            });
+            expect(decryptedString).to.equal(@"Rosebud");
+          });
+        });
+
         it(@"should be able to share with an encryption session", ^{
           TKREncryptionOptions* opts = [[TKREncryptionOptions alloc] init];
           opts.shareWithUsers = @[ bobPublicIdentity ];
@@ -1353,6 +2004,96 @@ SpecBegin(TankerSpecs)
           });
           expect(decryptedText).to.equal(clearData);
         });
+
+        describe(@"coalescing", ^{
+          __block TKRTanker* daveTanker;
+          __block NSArray<NSData*>* encryptedData;
+          __block NSArray<NSString*>* resourceIDs;
+
+          beforeEach(^{
+            TKRTankerOptions* options = createTankerOptions(url, appID);
+            options.shareCoalescingInterval = 0.2;
+            options.shareCoalescingMaxResources = 3;
+            daveTanker = [TKRTanker tankerWithOptions:options error:nil];
+            expect(daveTanker).toNot.beNil();
+            startWithIdentityAndRegister(daveTanker,
+                                         createIdentity(createUUID(), appID, appSecret),
+                                         [[TKRVerification alloc] withPassphrase:@"passphrase"]);
+
+            NSMutableArray<NSData*>* encrypted = [NSMutableArray array];
+            NSMutableArray<NSString*>* ids = [NSMutableArray array];
+            for (NSUInteger i = 0; i < 3; ++i)
+            {
+              NSData* data = hangWithAdapter(^(PMKAdapter adapter) {
+                [daveTanker encryptString:[NSString stringWithFormat:@"Rosebud %lu", (unsigned long)i]
+                        completionHandler:adapter];
+              });
+              [encrypted addObject:data];
+              [ids addObject:[daveTanker resourceIDOfEncryptedData:data error:nil]];
+            }
+            encryptedData = encrypted;
+            resourceIDs = ids;
+          });
+
+          afterEach(^{
+            stop(daveTanker);
+          });
+
+          it(@"should send shares to the same recipients as a single request", ^{
+            TKRSharingOptions* opts = [[TKRSharingOptions alloc] init];
+            opts.shareWithUsers = @[ bobPublicIdentity ];
+            NSArray* errors = hangWithResolver(^(PMKResolver resolve) {
+              NSMutableArray* results = [NSMutableArray array];
+              for (NSString* resourceID in resourceIDs)
+                [daveTanker shareResourceIDs:@[ resourceID ]
+                                     options:opts
+                           completionHandler:^(NSError* err) {
+                             [results addObject:err ?: [NSNull null]];
+                             if (results.count == resourceIDs.count)
+                               resolve(results);
+                           }];
+            });
+            expect(errors).to.equal(@[ [NSNull null], [NSNull null], [NSNull null] ]);
+            expect(daveTanker.shareBatcher.nativeShareCount).to.equal(1);
+
+            for (NSData* data in encryptedData)
+            {
+              NSString* decrypted = hangWithAdapter(^(PMKAdapter adapter) {
+                [bobTanker decryptStringFromData:data completionHandler:adapter];
+              });
+              expect(decrypted).to.beginWith(@"Rosebud");
+            }
+          });
+
+          it(@"should only report an error to the caller that caused it", ^{
+            TKRSharingOptions* opts = [[TKRSharingOptions alloc] init];
+            opts.shareWithUsers = @[ charliePublicIdentity ];
+            NSString* invalidResourceID = @"AAAAAAAAAAAAAAAAAAAAAA==";
+            NSArray<NSError*>* errors = hangWithResolver(^(PMKResolver resolve) {
+              NSMutableArray* results = [NSMutableArray arrayWithArray:@[ [NSNull null], [NSNull null] ]];
+              __block NSUInteger remaining = 2;
+              void (^share)(NSUInteger, NSString*) = ^(NSUInteger index, NSString* resourceID) {
+                [daveTanker shareResourceIDs:@[ resourceID ]
+                                     options:opts
+                           completionHandler:^(NSError* err) {
+                             if (err)
+                               results[index] = err;
+                             if (--remaining == 0)
+                               resolve(results);
+                           }];
+              };
+              share(0, resourceIDs[0]);
+              share(1, invalidResourceID);
+            });
+            expect(errors[0]).to.equal([NSNull null]);
+            expect(errors[1]).to.beKindOf([NSError class]);
+
+            NSString* decrypted = hangWithAdapter(^(PMKAdapter adapter) {
+              [charlieTanker decryptStringFromData:encryptedData[0] completionHandler:adapter];
+            });
+            expect(decrypted).to.equal(@"Rosebud 0");
+          });
+        });
       });
 
       describe(@"e2e passphrase", ^{
@@ -2024,6 +2765,115 @@ SpecBegin(TankerSpecs)
                 [[TKRVerification alloc] withOIDCIDToken:oidcToken]);
           });
         });
+
+        describe(@"cached verification methods", ^{
+          it(@"should notify the change after setting a verification method", ^{
+            NSString* email = @"bob.alice@tanker.io";
+            startWithIdentityAndRegister(
+                firstDevice, identity, [[TKRVerification alloc] withPassphrase:@"Rosebud"]);
+            NSArray<TKRVerificationMethod*>* methods = hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:adapter];
+            });
+            expect(methods.count).to.equal(1);
+
+            NSArray<TKRVerificationMethod*>* changedMethods = hangWithAdapter(^(PMKAdapter adapter) {
+              firstDevice.verificationMethodsChangeHandler = ^(NSArray<TKRVerificationMethod*>* methods) {
+                adapter(methods, nil);
+              };
+              [firstDevice setVerificationMethodWithVerification:[[TKRVerification alloc] withPreverifiedEmail:email]
+                                               completionHandler:^(NSError* err) {
+                                                 expect(err).to.beNil();
+                                               }];
+            });
+            expect(changedMethods.count).to.equal(2);
+
+            methods = hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:adapter];
+            });
+            expect(methods).to.equal(changedMethods);
+          });
+
+          it(@"should answer from the cache and revalidate in the background", ^{
+            NSString* email = @"bob.alice@tanker.io";
+            TKRTankerOptions* options = createTankerOptions(url, appID);
+            options.verificationMethodCacheMaxAge = 0.001;
+            firstDevice = [TKRTanker tankerWithOptions:options error:nil];
+            startWithIdentityAndRegister(
+                firstDevice, identity, [[TKRVerification alloc] withPassphrase:@"Rosebud"]);
+            startWithIdentityAndVerify(
+                secondDevice, identity, [[TKRVerification alloc] withPassphrase:@"Rosebud"]);
+            NSArray<TKRVerificationMethod*>* methods = hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:adapter];
+            });
+            expect(methods.count).to.equal(1);
+
+            NSError* err = hangWithResolver(^(PMKResolver resolver) {
+              [secondDevice setVerificationMethodWithVerification:[[TKRVerification alloc] withPreverifiedEmail:email]
+                                                completionHandler:resolver];
+            });
+            expect(err).to.beNil();
+
+            NSArray<TKRVerificationMethod*>* changedMethods = hangWithAdapter(^(PMKAdapter adapter) {
+              firstDevice.verificationMethodsChangeHandler = ^(NSArray<TKRVerificationMethod*>* methods) {
+                adapter(methods, nil);
+              };
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:^(NSArray* staleMethods, NSError* err) {
+                expect(err).to.beNil();
+                expect(staleMethods).to.equal(methods);
+              }];
+            });
+            expect(changedMethods.count).to.equal(2);
+          });
+
+          it(@"should not revalidate fresh methods", ^{
+            NSString* email = @"bob.alice@tanker.io";
+            startWithIdentityAndRegister(
+                firstDevice, identity, [[TKRVerification alloc] withPassphrase:@"Rosebud"]);
+            startWithIdentityAndVerify(
+                secondDevice, identity, [[TKRVerification alloc] withPassphrase:@"Rosebud"]);
+            NSArray<TKRVerificationMethod*>* methods = hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:adapter];
+            });
+            expect(methods.count).to.equal(1);
+
+            NSError* err = hangWithResolver(^(PMKResolver resolver) {
+              [secondDevice setVerificationMethodWithVerification:[[TKRVerification alloc] withPreverifiedEmail:email]
+                                                completionHandler:resolver];
+            });
+            expect(err).to.beNil();
+            NSArray<TKRVerificationMethod*>* cachedMethods = hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:adapter];
+            });
+            expect(cachedMethods).to.equal(methods);
+
+            // a revalidation started by the previous call would be over once the methods are fetched again
+            NSArray<TKRVerificationMethod*>* fetchedMethods = hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice verificationMethodsWithCompletionHandler:adapter];
+            });
+            expect(fetchedMethods.count).to.equal(2);
+            cachedMethods = hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:adapter];
+            });
+            expect(cachedMethods).to.equal(methods);
+          });
+
+          it(@"should fail when the tanker is stopped", ^{
+            startWithIdentityAndRegister(
+                firstDevice, identity, [[TKRVerification alloc] withPassphrase:@"Rosebud"]);
+            hangWithAdapter(^(PMKAdapter adapter) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:adapter];
+            });
+            stop(firstDevice);
+
+            NSError* err = hangWithResolver(^(PMKResolver resolver) {
+              [firstDevice cachedVerificationMethodsWithCompletionHandler:^(NSArray* methods, NSError* err) {
+                resolver(err);
+              }];
+            });
+            expect(err).toNot.beNil();
+            expect(err.code).to.equal(TKRErrorPreconditionFailed);
+          });
+        });
       });
 
       describe(@"session tokens (2FA)", ^{
@@ -2252,6 +3102,89 @@ SpecBegin(TankerSpecs)
           expect(values[0]).to.equal([NSNull null]);
         });
 
+        describe(@"write-behind", ^{
+          NSData* key = stringToData(@"key");
+
+          beforeEach(^{
+            db.writeBehindDelay = 60;
+          });
+
+          it(@"finds staged values and flushes them in a single commit", ^{
+            NSUInteger const commitsBefore = db.cacheCommitCount;
+            for (int i = 0; i < 10; ++i)
+            {
+              NSData* indexedKey = stringToData([NSString stringWithFormat:@"key%d", i]);
+              NSDictionary* keyValues = @{indexedKey : stringToData(@"value")};
+              expect([db cacheValues:keyValues onConflict:TKRDatastoreOnConflictFail]).to.beNil();
+            }
+            expect(db.cacheCommitCount).to.equal(commitsBefore);
+
+            NSError* err;
+            NSArray<id>* values = [db findCacheValuesWithKeys:@[ stringToData(@"key3"), key ] error:&err];
+            expect(err).to.beNil();
+            expect([values[0] isEqualToData:stringToData(@"value")]).to.beTruthy();
+            expect(values[1]).to.equal([NSNull null]);
+
+            expect([db flushCacheValues]).to.beNil();
+            expect(db.cacheCommitCount).to.equal(commitsBefore + 1);
+
+            values = [db findCacheValuesWithKeys:@[ stringToData(@"key3") ] error:&err];
+            expect(err).to.beNil();
+            expect([values[0] isEqualToData:stringToData(@"value")]).to.beTruthy();
+          });
+
+          it(@"keeps onConflict semantics for staged and stored values", ^{
+            NSError* err = [db cacheValues:@{key : stringToData(@"stored")} onConflict:TKRDatastoreOnConflictFail];
+            expect(err).to.beNil();
+            expect([db flushCacheValues]).to.beNil();
+
+            err = [db cacheValues:@{key : stringToData(@"ignored")} onConflict:TKRDatastoreOnConflictIgnore];
+            expect(err).to.beNil();
+            err = [db cacheValues:@{key : stringToData(@"failed")} onConflict:TKRDatastoreOnConflictFail];
+            expect(err.domain).to.equal(TKRDatastoreErrorDomain);
+            expect(err.code).to.equal(TKRDatastoreErrorConstraintFailed);
+
+            NSArray<id>* values = [db findCacheValuesWithKeys:@[ key ] error:&err];
+            expect(err).to.beNil();
+            expect([values[0] isEqualToData:stringToData(@"stored")]).to.beTruthy();
+
+            err = [db cacheValues:@{key : stringToData(@"replaced")} onConflict:TKRDatastoreOnConflictReplace];
+            expect(err).to.beNil();
+            err = [db cacheValues:@{key : stringToData(@"ignored")} onConflict:TKRDatastoreOnConflictIgnore];
+            expect(err).to.beNil();
+            expect([db flushCacheValues]).to.beNil();
+
+            values = [db findCacheValuesWithKeys:@[ key ] error:&err];
+            expect(err).to.beNil();
+            expect([values[0] isEqualToData:stringToData(@"replaced")]).to.beTruthy();
+          });
+
+          it(@"flushes staged values after the delay", ^{
+            db.writeBehindDelay = 0.01;
+            NSUInteger const commitsBefore = db.cacheCommitCount;
+            expect([db cacheValues:@{key : stringToData(@"value")} onConflict:TKRDatastoreOnConflictFail]).to.beNil();
+            expect(db.cacheCommitCount).will.equal(commitsBefore + 1);
+          });
+
+          it(@"discards staged values on nuke", ^{
+            expect([db cacheValues:@{key : stringToData(@"value")} onConflict:TKRDatastoreOnConflictFail]).to.beNil();
+            expect([db nuke]).to.beNil();
+            expect([db flushCacheValues]).to.beNil();
+
+            NSError* err;
+            NSArray<id>* values = [db findCacheValuesWithKeys:@[ key ] error:&err];
+            expect(err).to.beNil();
+            expect(values[0]).to.equal([NSNull null]);
+          });
+
+          it(@"flushes staged values on close", ^{
+            NSUInteger const commitsBefore = db.cacheCommitCount;
+            expect([db cacheValues:@{key : stringToData(@"value")} onConflict:TKRDatastoreOnConflictFail]).to.beNil();
+            [db close];
+            expect(db.cacheCommitCount).to.equal(commitsBefore + 1);
+          });
+        });
+
         it(@"runs C datastore-tests", ^{
           tanker_datastore_options_t opts = {.open = TKR_datastore_open,
                                              .close = TKR_datastore_close,